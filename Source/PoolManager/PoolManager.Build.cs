@@ -21,15 +21,20 @@ public class PoolManager : ModuleRules
 			{
 				"CoreUObject", "Engine", "Slate", "SlateCore" // Core
 				, "UMG" // Created UPoolFactory_UserWidget
+				, "MoviePlayer" // Keep loading spawn budget while loading screen is shown
+				, "AIModule" // Created UPoolFactory_Pawn
 			}
 		);
 
+		// Register "PoolManager" category in the Gameplay Debugger if it is available for the target
+		SetupGameplayDebuggerSupport(Target);
+
 		if (Target.bBuildEditor)
 		{
 			// Include Editor modules that are used in this Runtime module
 			PrivateDependencyModuleNames.AddRange(new[]
 				{
-					"UnrealEd" // GEditor
+					"UnrealEd" // GEditor, FScopedTransaction
 				}
 			);
 		}
@@ -0,0 +1,123 @@
+﻿// Copyright (c) Yevhenii Selivanov
+
+#include "Actors/PoolPrebakedActors.h"
+//---
+#include "PoolManagerSubsystem.h"
+//---
+#include "Engine/World.h"
+#if WITH_EDITOR
+#include "ScopedTransaction.h"
+#endif
+//---
+#include UE_INLINE_GENERATED_CPP_BY_NAME(PoolPrebakedActors)
+
+// Default constructor
+APoolPrebakedActors::APoolPrebakedActors()
+{
+	PrimaryActorTick.bCanEverTick = false;
+	PrimaryActorTick.bStartWithTickEnabled = false;
+
+	SetHidden(true);
+	SetCanBeDamaged(false);
+
+#if WITH_EDITORONLY_DATA
+	bIsSpatiallyLoaded = false; // Is always loaded with the level, the same as its baked actors
+#endif
+}
+
+#if WITH_EDITOR
+// Destroys previously baked actors and spawns new inactive ones of specified class and amount into the level of this actor
+void APoolPrebakedActors::GenerateBakedActors()
+{
+	UWorld* World = GetWorld();
+	if (!ensureMsgf(World && !World->IsGameWorld(), TEXT("ASSERT: [%i] %hs:\n'World' has to be the editor world to bake actors!"), __LINE__, __FUNCTION__)
+		|| !ensureMsgf(ActorClassInternal, TEXT("ASSERT: [%i] %hs:\n'Actor Class' is not set!"), __LINE__, __FUNCTION__))
+	{
+		return;
+	}
+
+	// Is undoable as one step together with clearing previously baked actors
+	const FScopedTransaction Transaction(NSLOCTEXT("PoolManager", "GenerateBakedActors", "Generate Baked Actors"));
+	Modify();
+	GetLevel()->Modify();
+
+	ClearBakedActors();
+
+	FActorSpawnParameters SpawnParameters;
+	SpawnParameters.OverrideLevel = GetLevel(); // Is saved and cooked with the level of this actor
+	SpawnParameters.SpawnCollisionHandlingOverride = ESpawnActorCollisionHandlingMethod::AlwaysSpawn;
+
+	const FTransform SpawnTransform(VECTOR_HALF_WORLD_MAX);
+	const FName FolderPath = *FString::Printf(TEXT("PoolManager/%s"), *GetActorLabel());
+
+	BakedActorsInternal.Reserve(AmountInternal);
+	for (int32 Index = 0; Index < AmountInternal; ++Index)
+	{
+		AActor* BakedActor = World->SpawnActor(ActorClassInternal, &SpawnTransform, SpawnParameters);
+		if (!ensureMsgf(BakedActor, TEXT("ASSERT: [%i] %hs:\n'BakedActor' failed to spawn!"), __LINE__, __FUNCTION__))
+		{
+			continue;
+		}
+
+		// Is inactive until taken from the pool
+		BakedActor->SetActorHiddenInGame(true);
+		BakedActor->SetActorEnableCollision(false);
+		BakedActor->SetIsSpatiallyLoaded(false); // Otherwise, World Partition streams it independently of this actor
+		BakedActor->SetFolderPath(FolderPath);
+
+		BakedActorsInternal.Emplace(BakedActor);
+	}
+}
+
+// Destroys all baked actors
+void APoolPrebakedActors::ClearBakedActors()
+{
+	UWorld* World = GetWorld();
+	if (!World)
+	{
+		return;
+	}
+
+	const FScopedTransaction Transaction(NSLOCTEXT("PoolManager", "ClearBakedActors", "Clear Baked Actors"));
+	Modify();
+
+	constexpr bool bShouldModifyLevel = true;
+	for (AActor* BakedActorIt : BakedActorsInternal)
+	{
+		if (IsValid(BakedActorIt))
+		{
+			World->EditorDestroyActor(BakedActorIt, bShouldModifyLevel);
+		}
+	}
+
+	BakedActorsInternal.Empty();
+}
+#endif // WITH_EDITOR
+
+// Is overridden to register all baked actors in the Pool Manager
+void APoolPrebakedActors::BeginPlay()
+{
+	Super::BeginPlay();
+
+	UPoolManagerSubsystem* PoolManager = UPoolManagerSubsystem::GetPoolManager(this);
+	if (!ensureMsgf(PoolManager, TEXT("ASSERT: [%i] %hs:\n'PoolManager' is not found!"), __LINE__, __FUNCTION__))
+	{
+		return;
+	}
+
+	TArray<FPoolObjectData> BakedObjects;
+	BakedObjects.Reserve(BakedActorsInternal.Num());
+	for (AActor* BakedActorIt : BakedActorsInternal)
+	{
+		if (!IsValid(BakedActorIt))
+		{
+			continue;
+		}
+
+		FPoolObjectData& ObjectData = BakedObjects.AddDefaulted_GetRef();
+		ObjectData.bIsActive = false;
+		ObjectData.PoolObject = BakedActorIt;
+	}
+
+	PoolManager->RegisterObjectsArrayInPool(BakedObjects);
+}
@@ -0,0 +1,49 @@
+﻿// Copyright (c) Yevhenii Selivanov
+
+#include "Components/PoolPredictionComponent.h"
+//---
+#include "PoolManagerSubsystem.h"
+//---
+#include "GameFramework/Actor.h"
+#include "Net/UnrealNetwork.h"
+//---
+#include UE_INLINE_GENERATED_CPP_BY_NAME(PoolPredictionComponent)
+
+// Default constructor
+UPoolPredictionComponent::UPoolPredictionComponent()
+{
+	PrimaryComponentTick.bCanEverTick = false;
+	PrimaryComponentTick.bStartWithTickEnabled = false;
+
+	SetIsReplicatedByDefault(true);
+}
+
+// Is called on the server to set the id of the client's stand-in that predicts the owner
+void UPoolPredictionComponent::SetPredictionId(const FGuid& NewPredictionId)
+{
+	PredictionIdInternal = NewPredictionId;
+}
+
+// Is called on client when the authoritative owner with new prediction id becomes relevant
+void UPoolPredictionComponent::OnRep_PredictionId()
+{
+	AActor* Owner = GetOwner();
+	if (!PredictionIdInternal.IsValid()
+		|| !Owner)
+	{
+		return;
+	}
+
+	if (UPoolManagerSubsystem* PoolManager = UPoolManagerSubsystem::GetPoolManager(this))
+	{
+		PoolManager->ReconcilePrediction(PredictionIdInternal, Owner);
+	}
+}
+
+// Returns properties that are replicated for the lifetime of the actor channel
+void UPoolPredictionComponent::GetLifetimeReplicatedProps(TArray<FLifetimeProperty>& OutLifetimeProps) const
+{
+	Super::GetLifetimeReplicatedProps(OutLifetimeProps);
+
+	DOREPLIFETIME(ThisClass, PredictionIdInternal);
+}
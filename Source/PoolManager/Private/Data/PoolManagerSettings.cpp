@@ -4,8 +4,139 @@
 //---
 #include "Factories/PoolFactory_UObject.h"
 //---
+#include "HAL/IConsoleManager.h"
+//---
 #include UE_INLINE_GENERATED_CPP_BY_NAME(PoolManagerSettings)
 
+/*********************************************************************************************
+ * Console Variables
+ * Can be set by device profiles and scalability groups to change budgets per platform.
+ ********************************************************************************************* */
+
+// Is broadcasted when any pool budget is changed by console variable
+FSimpleMulticastDelegate UPoolManagerSettings::OnPoolBudgetsChanged;
+
+// Is called when any pool budget is changed to adjust all pools live
+static void OnPoolBudgetChanged(IConsoleVariable* Variable)
+{
+	UPoolManagerSettings::OnPoolBudgetsChanged.Broadcast();
+}
+
+static TAutoConsoleVariable<int32> CVarSpawnObjectsPerFrame(
+	TEXT("PoolManager.SpawnObjectsPerFrame"),
+	-1,
+	TEXT("Overrides how many objects are spawned per frame.\n")
+	TEXT("-1 or 0: use 'Spawn Objects Per Frame' from Project Settings (default)"),
+	ECVF_Scalability);
+
+static TAutoConsoleVariable<int32> CVarLoadingSpawnObjectsPerFrame(
+	TEXT("PoolManager.LoadingSpawnObjectsPerFrame"),
+	-1,
+	TEXT("Overrides how many objects are spawned per frame while the map is loading.\n")
+	TEXT("-1 or 0: use 'Loading Spawn Objects Per Frame' from Project Settings (default)"),
+	ECVF_Scalability);
+
+static TAutoConsoleVariable<float> CVarSpawnBudgetMs(
+	TEXT("PoolManager.SpawnBudgetMs"),
+	-1.f,
+	TEXT("Overrides milliseconds of the game thread that spawning can take per frame during gameplay.\n")
+	TEXT("-1: use 'Spawn Budget Ms' from Project Settings (default)\n")
+	TEXT("0: only 'Spawn Objects Per Frame' is used"),
+	ECVF_Scalability);
+
+static TAutoConsoleVariable<int32> CVarMaxFreeObjectsPerPool(
+	TEXT("PoolManager.MaxFreeObjectsPerPool"),
+	-1,
+	TEXT("Maximum number of free objects each pool can keep, the rest are destroyed.\n")
+	TEXT("-1: unlimited (default)"),
+	FConsoleVariableDelegate::CreateStatic(&OnPoolBudgetChanged),
+	ECVF_Scalability);
+
+static TAutoConsoleVariable<float> CVarPrewarmMultiplier(
+	TEXT("PoolManager.PrewarmMultiplier"),
+	1.f,
+	TEXT("Multiplier of all pre-warmed amounts, e.g: 0.5 on low-end devices, 2 on high-end PCs.\n")
+	TEXT("1: pre-warm as requested (default)"),
+	FConsoleVariableDelegate::CreateStatic(&OnPoolBudgetChanged),
+	ECVF_Scalability);
+
+static TAutoConsoleVariable<float> CVarMemoryBudgetMB(
+	TEXT("PoolManager.MemoryBudgetMB"),
+	0.f,
+	TEXT("Estimated memory in megabytes that free objects of all pools can take, free objects of the heaviest pools are destroyed first.\n")
+	TEXT("0: unlimited (default)"),
+	FConsoleVariableDelegate::CreateStatic(&OnPoolBudgetChanged),
+	ECVF_Scalability);
+
+static TAutoConsoleVariable<float> CVarStatsLogInterval(
+	TEXT("PoolManager.StatsLogInterval"),
+	0.f,
+	TEXT("How often in seconds the summary of hits, misses and latency percentiles of all pools is printed to the log.\n")
+	TEXT("0: never (default)"),
+	ECVF_Default);
+
+static TAutoConsoleVariable<float> CVarLeakThresholdSeconds(
+	TEXT("PoolManager.LeakThresholdSeconds"),
+	120.f,
+	TEXT("Default seconds after which active object is reported as leaked if it's never returned to the pool.\n")
+	TEXT("0: never report leaks"),
+	ECVF_Default);
+
+/*********************************************************************************************
+ * Getters
+ ********************************************************************************************* */
+
+// Returns a limit of how many actors to spawn per frame
+int32 UPoolManagerSettings::GetSpawnObjectsPerFrame() const
+{
+	const int32 CVarValue = CVarSpawnObjectsPerFrame.GetValueOnGameThread();
+	return CVarValue > 0 ? CVarValue : SpawnObjectsPerFrame;
+}
+
+// Returns a limit of how many actors to spawn per frame while the map is loading
+int32 UPoolManagerSettings::GetLoadingSpawnObjectsPerFrame() const
+{
+	const int32 CVarValue = CVarLoadingSpawnObjectsPerFrame.GetValueOnGameThread();
+	return CVarValue > 0 ? CVarValue : LoadingSpawnObjectsPerFrame;
+}
+
+// Returns milliseconds of the game thread that spawning can take per frame during gameplay, 0 means only objects count is limited
+float UPoolManagerSettings::GetSpawnBudgetMs() const
+{
+	const float CVarValue = CVarSpawnBudgetMs.GetValueOnGameThread();
+	return CVarValue >= 0.f ? CVarValue : SpawnBudgetMs;
+}
+
+// Returns the maximum number of free objects each pool can keep, -1 means unlimited
+int32 UPoolManagerSettings::GetMaxFreeObjectsPerPool() const
+{
+	return CVarMaxFreeObjectsPerPool.GetValueOnGameThread();
+}
+
+// Returns the multiplier of all pre-warmed amounts
+float UPoolManagerSettings::GetPrewarmMultiplier() const
+{
+	return FMath::Max(CVarPrewarmMultiplier.GetValueOnGameThread(), 0.f);
+}
+
+// Returns estimated memory in megabytes that free objects of all pools can take, 0 means unlimited
+float UPoolManagerSettings::GetMemoryBudgetMB() const
+{
+	return CVarMemoryBudgetMB.GetValueOnGameThread();
+}
+
+// Returns how often in seconds the summary of pool stats is printed to the log, 0 means never
+float UPoolManagerSettings::GetStatsLogInterval() const
+{
+	return FMath::Max(CVarStatsLogInterval.GetValueOnGameThread(), 0.f);
+}
+
+// Returns default seconds after which active object is reported as leaked if it's never returned, 0 means never
+float UPoolManagerSettings::GetLeakThresholdSeconds() const
+{
+	return FMath::Max(CVarLeakThresholdSeconds.GetValueOnGameThread(), 0.f);
+}
+
 // Returns all Pool Factories that will be used by the Pool Manager
 void UPoolManagerSettings::GetPoolFactories(TArray<UClass*>& OutBlueprintPoolFactories) const
 {
@@ -0,0 +1,179 @@
+﻿// Copyright (c) Yevhenii Selivanov
+
+#include "Debug/GameplayDebuggerCategory_PoolManager.h"
+
+#if WITH_GAMEPLAY_DEBUGGER
+#include "PoolManagerSubsystem.h"
+#include "Factories/PoolFactory_UObject.h"
+//---
+#include "Engine/World.h"
+#include "GameFramework/PlayerController.h"
+
+// Default constructor
+FGameplayDebuggerCategory_PoolManager::FGameplayDebuggerCategory_PoolManager()
+{
+	bShowOnlyWithDebugActor = false;
+	SetDataPackReplication<FRepData>(&DataPack);
+}
+
+// Creates new instance of this category
+TSharedRef<FGameplayDebuggerCategory> FGameplayDebuggerCategory_PoolManager::MakeInstance()
+{
+	return MakeShared<FGameplayDebuggerCategory_PoolManager>();
+}
+
+// Is called on the server (or locally in standalone) to collect the data of the Pool Manager
+void FGameplayDebuggerCategory_PoolManager::CollectData(APlayerController* OwnerPC, AActor* DebugActor)
+{
+	DataPack.Pools.Reset();
+	DataPack.Factories.Reset();
+
+	const UWorld* World = OwnerPC ? OwnerPC->GetWorld() : nullptr;
+	const UPoolManagerSubsystem* PoolManager = World ? World->GetSubsystem<UPoolManagerSubsystem>() : nullptr;
+	if (!PoolManager)
+	{
+		return;
+	}
+
+	// --- Pools, sorted by misses, so the classes under the most pressure are on top
+	static const TCHAR SparklineChars[] = TEXT("_.-:=+*#");
+	constexpr int32 SparklineLevelsNum = UE_ARRAY_COUNT(SparklineChars) - 1;
+	const TMap<const UClass*, FPoolTakeHistory>& TakeHistory = PoolManager->GetTakeHistory();
+	for (const FPoolContainer& PoolIt : PoolManager->GetAllPools())
+	{
+		if (!PoolIt.ObjectClass)
+		{
+			continue;
+		}
+
+		FPoolRepData& PoolData = DataPack.Pools.AddDefaulted_GetRef();
+		PoolData.ClassName = PoolIt.ObjectClass->GetName();
+		PoolData.FreeNum = PoolManager->GetFreeObjectsNum(PoolIt.ObjectClass);
+		PoolData.ActiveNum = PoolManager->GetRegisteredObjectsNum(PoolIt.ObjectClass) - PoolData.FreeNum;
+
+		const FPoolTakeHistory* History = TakeHistory.Find(PoolIt.ObjectClass);
+		if (!History)
+		{
+			continue;
+		}
+
+		PoolData.MissesNum = History->GetMissesNum(MissesWindowSeconds);
+
+		int32 MaxTakesNum = 1;
+		for (int32 Index = 0; Index < FPoolTakeHistory::SecondsNum; ++Index)
+		{
+			MaxTakesNum = FMath::Max(MaxTakesNum, History->GetTakesNum(Index));
+		}
+
+		PoolData.TakesSparkline.Reserve(FPoolTakeHistory::SecondsNum);
+		for (int32 Index = 0; Index < FPoolTakeHistory::SecondsNum; ++Index)
+		{
+			const int32 Level = History->GetTakesNum(Index) * (SparklineLevelsNum - 1) / MaxTakesNum;
+			PoolData.TakesSparkline.AppendChar(SparklineChars[Level]);
+		}
+	}
+
+	DataPack.Pools.Sort([](const FPoolRepData& A, const FPoolRepData& B)
+	{
+		return A.MissesNum > B.MissesNum;
+	});
+
+	// --- Spawn queues of factories
+	for (const TTuple<TObjectPtr<const UClass>, TObjectPtr<UPoolFactory_UObject>>& It : PoolManager->GetAllFactories())
+	{
+		const UPoolFactory_UObject* Factory = It.Value;
+		if (!Factory)
+		{
+			continue;
+		}
+
+		FFactoryRepData& FactoryData = DataPack.Factories.AddDefaulted_GetRef();
+		FactoryData.FactoryName = Factory->GetClass()->GetName();
+
+		uint64 OldestFrame = GFrameCounter;
+		for (const FSpawnRequest& RequestIt : Factory->GetSpawnQueue())
+		{
+			OldestFrame = FMath::Min(OldestFrame, RequestIt.RequestedFrame);
+			switch (RequestIt.Priority)
+			{
+			case ESpawnRequestPriority::Critical:
+				++FactoryData.CriticalNum;
+				break;
+			case ESpawnRequestPriority::High:
+				++FactoryData.HighNum;
+				break;
+			case ESpawnRequestPriority::Medium:
+				++FactoryData.MediumNum;
+				break;
+			default:
+				++FactoryData.NormalNum;
+				break;
+			}
+		}
+		FactoryData.OldestWaitFrames = static_cast<int32>(GFrameCounter - OldestFrame);
+	}
+}
+
+// Is called on the client to draw collected data
+void FGameplayDebuggerCategory_PoolManager::DrawData(APlayerController* OwnerPC, FGameplayDebuggerCanvasContext& CanvasContext)
+{
+	CanvasContext.Printf(TEXT("{white}Pools: {yellow}%i"), DataPack.Pools.Num());
+	for (const FPoolRepData& PoolIt : DataPack.Pools)
+	{
+		CanvasContext.Printf(TEXT("  {white}%-40s {green}free %4i  {orange}active %4i  {grey}takes/s [%s]"),
+		                     *PoolIt.ClassName, PoolIt.FreeNum, PoolIt.ActiveNum, *PoolIt.TakesSparkline);
+	}
+
+	CanvasContext.Printf(TEXT("\n{white}Spawn queues:"));
+	for (const FFactoryRepData& FactoryIt : DataPack.Factories)
+	{
+		const int32 QueuedNum = FactoryIt.CriticalNum + FactoryIt.HighNum + FactoryIt.MediumNum + FactoryIt.NormalNum;
+		CanvasContext.Printf(TEXT("  {white}%-40s {yellow}%4i {grey}(high %i, medium %i, normal %i)  oldest waits {%s}%i {grey}frames"),
+		                     *FactoryIt.FactoryName, QueuedNum, FactoryIt.HighNum, FactoryIt.MediumNum, FactoryIt.NormalNum,
+		                     FactoryIt.OldestWaitFrames > 0 ? TEXT("red") : TEXT("green"), FactoryIt.OldestWaitFrames);
+	}
+
+	CanvasContext.Printf(TEXT("\n{white}Most misses in last %i seconds:"), MissesWindowSeconds);
+	for (int32 Index = 0; Index < FMath::Min(TopMissesNum, DataPack.Pools.Num()); ++Index)
+	{
+		const FPoolRepData& PoolIt = DataPack.Pools[Index];
+		if (PoolIt.MissesNum <= 0)
+		{
+			break;
+		}
+
+		CanvasContext.Printf(TEXT("  {red}%4i {white}%s"), PoolIt.MissesNum, *PoolIt.ClassName);
+	}
+}
+
+// Serializes replicated data of one pool
+FArchive& operator<<(FArchive& Ar, FGameplayDebuggerCategory_PoolManager::FPoolRepData& Data)
+{
+	Ar << Data.ClassName;
+	Ar << Data.FreeNum;
+	Ar << Data.ActiveNum;
+	Ar << Data.MissesNum;
+	Ar << Data.TakesSparkline;
+	return Ar;
+}
+
+// Serializes replicated data of one factory
+FArchive& operator<<(FArchive& Ar, FGameplayDebuggerCategory_PoolManager::FFactoryRepData& Data)
+{
+	Ar << Data.FactoryName;
+	Ar << Data.CriticalNum;
+	Ar << Data.HighNum;
+	Ar << Data.MediumNum;
+	Ar << Data.NormalNum;
+	Ar << Data.OldestWaitFrames;
+	return Ar;
+}
+
+// Serializes all replicated data of this category
+void FGameplayDebuggerCategory_PoolManager::FRepData::Serialize(FArchive& Ar)
+{
+	Ar << Pools;
+	Ar << Factories;
+}
+
+#endif // WITH_GAMEPLAY_DEBUGGER
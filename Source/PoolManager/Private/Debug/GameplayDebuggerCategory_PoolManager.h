@@ -0,0 +1,71 @@
+﻿// Copyright (c) Yevhenii Selivanov
+
+#pragma once
+
+#if WITH_GAMEPLAY_DEBUGGER
+#include "GameplayDebuggerCategory.h"
+
+/**
+ * Shows the pool pressure while playing: 'Apostrophe' key -> "PoolManager" category.
+ * - Free and active objects of each pool with the sparkline of takes per second.
+ * - Depth of each factory's spawn queue by priority and frames waited by its oldest request.
+ * - Classes with the most misses (takes with no free objects) in the last seconds.
+ * Data is collected on the server and replicated to the client in networked sessions.
+ */
+class FGameplayDebuggerCategory_PoolManager : public FGameplayDebuggerCategory
+{
+public:
+	/** Default constructor. */
+	FGameplayDebuggerCategory_PoolManager();
+
+	/** Creates new instance of this category, is registered in FPoolManagerModule. */
+	static TSharedRef<FGameplayDebuggerCategory> MakeInstance();
+
+	/** Is called on the server (or locally in standalone) to collect the data of the Pool Manager. */
+	virtual void CollectData(APlayerController* OwnerPC, AActor* DebugActor) override;
+
+	/** Is called on the client to draw collected data. */
+	virtual void DrawData(APlayerController* OwnerPC, FGameplayDebuggerCanvasContext& CanvasContext) override;
+
+	/** Number of last seconds to find classes with the most misses. */
+	static constexpr int32 MissesWindowSeconds = 10;
+
+	/** Maximum number of classes with the most misses to show. */
+	static constexpr int32 TopMissesNum = 5;
+
+	/** Replicated data of one pool. */
+	struct FPoolRepData
+	{
+		FString ClassName;
+		int32 FreeNum = 0;
+		int32 ActiveNum = 0;
+		int32 MissesNum = 0;
+		FString TakesSparkline;
+	};
+
+	/** Replicated data of one factory. */
+	struct FFactoryRepData
+	{
+		FString FactoryName;
+		int32 CriticalNum = 0; // Is never queued, but kept for consistency of all priorities
+		int32 HighNum = 0;
+		int32 MediumNum = 0;
+		int32 NormalNum = 0;
+		int32 OldestWaitFrames = 0;
+	};
+
+	/** All replicated data of this category. */
+	struct FRepData
+	{
+		TArray<FPoolRepData> Pools;
+		TArray<FFactoryRepData> Factories;
+
+		void Serialize(FArchive& Ar);
+	};
+
+protected:
+	/** Data that is collected on the server and replicated to the client. */
+	FRepData DataPack;
+};
+
+#endif // WITH_GAMEPLAY_DEBUGGER
@@ -2,14 +2,24 @@
 
 #include "Factories/PoolFactory_Actor.h"
 //---
+#include "PoolManagerSubsystem.h"
+#include "Components/PoolPredictionComponent.h"
+//---
+#include "Components/ActorComponent.h"
+#include "Components/ChildActorComponent.h"
+#include "Components/AudioComponent.h"
+#include "Components/DecalComponent.h"
+#include "Components/InstancedStaticMeshComponent.h"
+#include "Components/SkeletalMeshComponent.h"
 #include "Engine/World.h"
+#include "AI/NavigationSystemBase.h"
 #include "GameFramework/Actor.h"
+#include "GameFramework/ProjectileMovementComponent.h"
+#include "Particles/ParticleSystemComponent.h"
+#include "TimerManager.h"
 //---
 #include UE_INLINE_GENERATED_CPP_BY_NAME(PoolFactory_Actor)
 
-// It's almost farthest possible location where deactivated actors are placed
-#define VECTOR_HALF_WORLD_MAX FVector(HALF_WORLD_MAX - HALF_WORLD_MAX * THRESH_VECTOR_NORMALIZED)
-
 // Is overridden to handle Actors-inherited classes
 const UClass* UPoolFactory_Actor::GetObjectClass_Implementation() const
 {
@@ -37,7 +47,10 @@ UObject* UPoolFactory_Actor::SpawnNow_Implementation(const FSpawnRequest& Reques
 	SpawnParameters.bCreateActorPackage = false; // Do not bake this runtime actor into World Partition level
 #endif
 
-	return World->SpawnActor(Request.GetClassChecked<AActor>(), &Request.Transform, SpawnParameters);
+	// Pre-warmed actor is not taken yet, so spawn it where all free actors are placed
+	// Its lifetime follows the streaming source by UPoolManagerSubsystem::AddStreamingPool() instead of its level
+	const FTransform SpawnTransform = Request.bIsPrewarm ? FTransform(VECTOR_HALF_WORLD_MAX) : Request.Transform;
+	return World->SpawnActor(Request.GetClassChecked<AActor>(), &SpawnTransform, SpawnParameters);
 }
 
 // Is overridden to finish spawning the actor since it was deferred
@@ -46,7 +59,21 @@ void UPoolFactory_Actor::OnPreRegistered(const FSpawnRequest& Request, const FPo
 	Super::OnPreRegistered(Request, ObjectData);
 
 	AActor& SpawnedActor = ObjectData.GetChecked<AActor>();
-	SpawnedActor.FinishSpawning(Request.Transform);
+	SpawnedActor.FinishSpawning(Request.bIsPrewarm ? FTransform(VECTOR_HALF_WORLD_MAX) : Request.Transform);
+
+	// Children are spawned by construction scripts and BeginPlay, so they are known only now
+	RefreshCompoundChildren(SpawnedActor);
+	const bool bActivate = ObjectData.bIsActive;
+
+	// Root is applied again as well, since its components were created and activated only by finishing spawning
+	SetActorStateInPool(SpawnedActor, bActivate);
+	for (const TWeakObjectPtr<AActor>& ChildIt : CompoundChildrenInternal.FindRef(&SpawnedActor))
+	{
+		if (AActor* Child = ChildIt.Get())
+		{
+			SetActorStateInPool(*Child, bActivate);
+		}
+	}
 }
 
 /*********************************************************************************************
@@ -60,6 +87,43 @@ void UPoolFactory_Actor::Destroy_Implementation(UObject* Object)
 
 	AActor* Actor = CastChecked<AActor>(Object);
 	checkf(IsValid(Actor), TEXT("ERROR: [%i] %hs:\n'IsValid(Actor)' is null!"), __LINE__, __FUNCTION__);
+
+	// Saved states of skeletal meshes are not needed anymore
+	const auto ForgetSkeletalMeshStates = [this](const AActor& InActor)
+	{
+		constexpr bool bIncludeFromChildActors = false;
+		InActor.ForEachComponent<USkeletalMeshComponent>(bIncludeFromChildActors, [this](const USkeletalMeshComponent* SkeletalMesh)
+		{
+			SkeletalMeshStatesInternal.Remove(SkeletalMesh);
+		});
+	};
+
+	// Children are destroyed together with their root, except those that are destroyed by their child actor components
+	RefreshCompoundChildren(*Actor);
+	TArray<TWeakObjectPtr<AActor>> Children;
+	CompoundChildrenInternal.RemoveAndCopyValue(Actor, Children);
+	for (const TWeakObjectPtr<AActor>& ChildIt : Children)
+	{
+		AActor* Child = ChildIt.Get();
+		if (IsValid(Child))
+		{
+			ForgetSkeletalMeshStates(*Child);
+			TickStatesInternal.Remove(Child);
+			ComponentResetBindingsInternal.Remove(Child);
+			ReleaseProxySlot(*Child);
+			NavigationComponentsInternal.Remove(Child);
+			if (!Child->IsChildActor())
+			{
+				Child->Destroy();
+			}
+		}
+	}
+
+	ForgetSkeletalMeshStates(*Actor);
+	TickStatesInternal.Remove(Actor);
+	ComponentResetBindingsInternal.Remove(Actor);
+	ReleaseProxySlot(*Actor);
+	NavigationComponentsInternal.Remove(Actor);
 	Actor->Destroy();
 }
 
@@ -67,13 +131,45 @@ void UPoolFactory_Actor::Destroy_Implementation(UObject* Object)
  * Pool
  ********************************************************************************************* */
 
-// Is overridden to set transform to the actor before taking the object from its pool
-void UPoolFactory_Actor::OnTakeFromPool_Implementation(UObject* Object, const FTransform& Transform)
+// Is overridden to set transform and reset components of the actor before taking the object from its pool
+void UPoolFactory_Actor::OnTakeFromPool_Implementation(UObject* Object, const FTransform& Transform, const FInstancedStruct& Payload)
 {
-	Super::OnTakeFromPool_Implementation(Object, Transform);
-
 	AActor* Actor = CastChecked<AActor>(Object);
+
+	// Actors registered with no spawning by this factory, e.g: baked into the level, are not known yet
+	if (!CompoundChildrenInternal.Contains(Actor))
+	{
+		RefreshCompoundChildren(*Actor);
+	}
+
+	// Wake up before any change, so all of them are detected and sent within the same replicated update
+	LeaveNetDormancy(*Actor);
+	for (const TWeakObjectPtr<AActor>& ChildIt : CompoundChildrenInternal.FindRef(Actor))
+	{
+		if (AActor* Child = ChildIt.Get())
+		{
+			LeaveNetDormancy(*Child);
+		}
+	}
+
+	// Attached children follow their root
 	Actor->SetActorTransform(Transform);
+
+	// Components are reset before the object's callback, so it could override the defaults, e.g: launch the projectile with its own velocity
+	// Navigation is restored right at the new location, so AI could path around the actor in the same frame
+	constexpr bool bActivate = true;
+	ResetComponentsInPool(*Actor, bActivate);
+	SetNavigationStateInPool(*Actor, bActivate);
+	for (const TWeakObjectPtr<AActor>& ChildIt : CompoundChildrenInternal.FindRef(Actor))
+	{
+		if (AActor* Child = ChildIt.Get())
+		{
+			ResetComponentsInPool(*Child, bActivate);
+			SetNavigationStateInPool(*Child, bActivate);
+		}
+	}
+
+	Super::OnTakeFromPool_Implementation(Object, Transform, Payload);
 }
 
 // Is overridden to reset transform to the actor before returning the object to its pool
@@ -81,8 +177,32 @@ void UPoolFactory_Actor::OnReturnToPool_Implementation(UObject* Object)
 {
 	Super::OnReturnToPool_Implementation(Object);
 
-	// SetCollisionEnabled is not replicated, client collides with hidden actor, so move it far away
+	// Children could be attached while the actor was active, so all of them are returned together
 	AActor* Actor = CastChecked<AActor>(Object);
+
+	// Reused actor must not reconcile against the stand-in of its previous prediction, is sent before going dormant
+	UPoolPredictionComponent* PredictionComponent = Actor->HasAuthority() ? Actor->FindComponentByClass<UPoolPredictionComponent>() : nullptr;
+	if (PredictionComponent
+		&& PredictionComponent->GetPredictionId().IsValid())
+	{
+		PredictionComponent->SetPredictionId(FGuid());
+	}
+	RefreshCompoundChildren(*Actor);
+
+	// Navigation is updated only where the actor is, not where it is moved to, instances are freed there as well
+	constexpr bool bActivate = false;
+	SetNavigationStateInPool(*Actor, bActivate);
+	ReleaseProxySlot(*Actor);
+	for (const TWeakObjectPtr<AActor>& ChildIt : CompoundChildrenInternal.FindRef(Actor))
+	{
+		if (AActor* Child = ChildIt.Get())
+		{
+			SetNavigationStateInPool(*Child, bActivate);
+			ReleaseProxySlot(*Child);
+		}
+	}
+
+	// SetCollisionEnabled is not replicated, client collides with hidden actor, so move it far away
 	Actor->SetActorLocation(VECTOR_HALF_WORLD_MAX);
 }
 
@@ -94,7 +214,966 @@ void UPoolFactory_Actor::OnChangedStateInPool_Implementation(EPoolObjectState Ne
 	AActor* Actor = CastChecked<AActor>(InObject);
 	const bool bActivate = NewState == EPoolObjectState::Active;
 
-	Actor->SetActorHiddenInGame(!bActivate);
-	Actor->SetActorEnableCollision(bActivate);
-	Actor->SetActorTickEnabled(bActivate);
+	// Actors registered with no spawning by this factory, e.g: baked into the level, are not known yet
+	if (!CompoundChildrenInternal.Contains(Actor))
+	{
+		RefreshCompoundChildren(*Actor);
+	}
+
+	SetActorStateInPool(*Actor, bActivate);
+	for (const TWeakObjectPtr<AActor>& ChildIt : CompoundChildrenInternal.FindRef(Actor))
+	{
+		if (AActor* Child = ChildIt.Get())
+		{
+			SetActorStateInPool(*Child, bActivate);
+		}
+	}
+}
+
+// Is overridden to keep only actors that were moved out of destroying world by seamless travel
+bool UPoolFactory_Actor::CanPersistAcrossTravel_Implementation(const UObject* Object) const
+{
+	const AActor* Actor = Cast<AActor>(Object);
+	return Super::CanPersistAcrossTravel_Implementation(Object)
+		&& Actor
+		&& !Actor->IsActorBeingDestroyed()
+		&& Actor->GetWorld() != GetWorld(); // Otherwise, is not in the seamless travel list and will be destroyed with its world
+}
+
+// Is overridden to include memory of all components of the actor
+int64 UPoolFactory_Actor::EstimateObjectSize_Implementation(const UObject* Object) const
+{
+	int64 SizeBytes = Super::EstimateObjectSize_Implementation(Object);
+
+	if (const AActor* Actor = Cast<AActor>(Object))
+	{
+		constexpr bool bIncludeFromChildActors = false;
+		Actor->ForEachComponent(bIncludeFromChildActors, [&SizeBytes](UActorComponent* Component)
+		{
+			SizeBytes += static_cast<int64>(Component->GetResourceSizeBytes(EResourceSizeMode::EstimatedTotal));
+		});
+
+		// Compound children are kept in the pool together with their root
+		TArray<AActor*> Children;
+		GetCompoundChildren(Actor, /*out*/Children);
+		for (const AActor* ChildIt : Children)
+		{
+			SizeBytes += EstimateObjectSize(ChildIt);
+		}
+	}
+
+	return SizeBytes;
+}
+
+/*********************************************************************************************
+ * Compound
+ ********************************************************************************************* */
+
+// Returns actors that are pooled together with given root actor
+void UPoolFactory_Actor::GetCompoundChildren(const AActor* RootActor, TArray<AActor*>& OutChildren) const
+{
+	if (!OutChildren.IsEmpty())
+	{
+		OutChildren.Empty();
+	}
+
+	const TArray<TWeakObjectPtr<AActor>>* Children = RootActor ? CompoundChildrenInternal.Find(RootActor) : nullptr;
+	if (!Children)
+	{
+		return;
+	}
+
+	for (const TWeakObjectPtr<AActor>& ChildIt : *Children)
+	{
+		if (AActor* Child = ChildIt.Get())
+		{
+			OutChildren.Emplace(Child);
+		}
+	}
+}
+
+// Collects attached actors of given root actor to be pooled together with it
+void UPoolFactory_Actor::RefreshCompoundChildren(AActor& RootActor)
+{
+	if (!bPoolAttachedActors)
+	{
+		return;
+	}
+
+	// Entry is kept even with no children, so the hierarchy is not collected again on each state change
+	TArray<TWeakObjectPtr<AActor>>& Children = CompoundChildrenInternal.FindOrAdd(&RootActor);
+	Children.Reset();
+
+	TArray<AActor*> AttachedActors;
+	constexpr bool bResetArray = true;
+	constexpr bool bRecursivelyIncludeAttachedActors = true;
+	RootActor.GetAttachedActors(/*out*/AttachedActors, bResetArray, bRecursivelyIncludeAttachedActors);
+
+	// Only actors that belong to the root are included, so collect them from the root down regardless of the attachment order
+	TSet<const AActor*> BelongingActors;
+	BelongingActors.Add(&RootActor);
+	const UPoolManagerSubsystem* PoolManager = GetPoolManager();
+	bool bIsAnyAdded = true;
+	while (bIsAnyAdded)
+	{
+		bIsAnyAdded = false;
+		for (int32 Index = AttachedActors.Num() - 1; Index >= 0; --Index)
+		{
+			AActor* AttachedActorIt = AttachedActors[Index];
+			if (!IsValid(AttachedActorIt)
+				|| (PoolManager && PoolManager->IsRegistered(AttachedActorIt))) // Has own pool entry, so is returned by outer code
+			{
+				AttachedActors.RemoveAtSwap(Index);
+				continue;
+			}
+
+			const UChildActorComponent* ParentComponent = AttachedActorIt->GetParentComponent();
+			if (BelongingActors.Contains(AttachedActorIt->GetOwner())
+				|| (ParentComponent && BelongingActors.Contains(ParentComponent->GetOwner())))
+			{
+				BelongingActors.Add(AttachedActorIt);
+				Children.Emplace(AttachedActorIt);
+				AttachedActors.RemoveAtSwap(Index);
+				bIsAnyAdded = true;
+			}
+		}
+	}
+}
+
+// Changes visibility, collision, ticking and dormancy of given actor according to new state
+void UPoolFactory_Actor::SetActorStateInPool(AActor& Actor, bool bActivate)
+{
+	Actor.SetActorHiddenInGame(!bActivate);
+	Actor.SetActorEnableCollision(bActivate);
+	SetSkeletalMeshesStateInPool(Actor, bActivate);
+	SetTickStateInPool(Actor, bActivate);
+	SetNavigationStateInPool(Actor, bActivate);
+	SetInstancedProxyStateInPool(Actor, bActivate);
+
+	if (bActivate)
+	{
+		// Send the transform, visibility and all payload changes at once instead of waiting for next net update
+		if (CanBeDormantInPool(&Actor))
+		{
+			Actor.ForceNetUpdate();
+		}
+	}
+	else
+	{
+		// Components are reset on take already before the object's callback, see OnTakeFromPool
+		ResetComponentsInPool(Actor, bActivate);
+
+		// All changes are done, so the last replicated update is sent before the channel goes dormant
+		EnterNetDormancy(Actor);
+	}
+}
+
+/*********************************************************************************************
+ * Tick Suspension
+ ********************************************************************************************* */
+
+// Suspends tick functions of given actor and all its components, or enables back exactly those that were ticking
+void UPoolFactory_Actor::SetTickStateInPool(AActor& Actor, bool bActivate)
+{
+	constexpr bool bIncludeFromChildActors = false;
+
+	if (bActivate)
+	{
+		FPoolTickState TickState;
+		if (!TickStatesInternal.RemoveAndCopyValue(&Actor, TickState))
+		{
+			// Was never returned to the pool, so its ticking is as designed
+			return;
+		}
+
+		Actor.SetActorTickEnabled(TickState.bWasActorTickEnabled);
+		for (const TWeakObjectPtr<UActorComponent>& ComponentIt : TickState.TickingComponents)
+		{
+			if (UActorComponent* Component = ComponentIt.Get())
+			{
+				Component->SetComponentTickEnabled(true);
+			}
+		}
+
+		if (UWorld* World = Actor.GetWorld())
+		{
+			// Timers are resumed with the time that was left on return, cleared ones are skipped by the timer manager
+			FTimerManager& TimerManager = World->GetTimerManager();
+			for (const FTimerHandle& TimerIt : TickState.PausedTimers)
+			{
+				TimerManager.UnPauseTimer(TimerIt);
+			}
+		}
+		return;
+	}
+
+	// Is appended if already suspended, e.g: components that were enabled by spawning of pre-warmed actor
+	FPoolTickState& TickState = TickStatesInternal.FindOrAdd(&Actor);
+	TickState.bWasActorTickEnabled |= Actor.IsActorTickEnabled();
+	Actor.SetActorTickEnabled(false);
+
+	// Only ticking components are recorded, most of components do not tick at all
+	Actor.ForEachComponent(bIncludeFromChildActors, [&TickState](UActorComponent* Component)
+	{
+		if (Component->IsComponentTickEnabled())
+		{
+			TickState.TickingComponents.AddUnique(Component);
+			Component->SetComponentTickEnabled(false);
+		}
+	});
+
+	UWorld* World = Actor.GetWorld();
+	if (!World)
+	{
+		return;
+	}
+
+	FTimerManager& TimerManager = World->GetTimerManager();
+	if (!bClearTimersInPool)
+	{
+		PauseTimersInPool(Actor, TimerManager, TickState.PausedTimers);
+		Actor.ForEachComponent(bIncludeFromChildActors, [this, &TimerManager, &TickState](UActorComponent* Component)
+		{
+			PauseTimersInPool(*Component, TimerManager, TickState.PausedTimers);
+		});
+		return;
+	}
+
+	FLatentActionManager& LatentActionManager = World->GetLatentActionManager();
+	TimerManager.ClearAllTimersForObject(&Actor);
+	LatentActionManager.RemoveActionsForObject(&Actor);
+	Actor.ForEachComponent(bIncludeFromChildActors, [&TimerManager, &LatentActionManager](UActorComponent* Component)
+	{
+		TimerManager.ClearAllTimersForObject(Component);
+		LatentActionManager.RemoveActionsForObject(Component);
+	});
+}
+
+// Pauses running timers of given object whose handles are stored in its properties
+void UPoolFactory_Actor::PauseTimersInPool(UObject& Object, FTimerManager& TimerManager, TArray<FTimerHandle>& OutPausedTimers)
+{
+	const UClass* ObjectClass = Object.GetClass();
+	TArray<const FStructProperty*>* TimerProperties = TimerPropertiesInternal.Find(ObjectClass);
+	if (!TimerProperties)
+	{
+		// Most of classes have no timer handles at all, so empty list is cached as well
+		TimerProperties = &TimerPropertiesInternal.Add(ObjectClass);
+		for (TFieldIterator<FStructProperty> It(ObjectClass); It; ++It)
+		{
+			if (It->Struct == FTimerHandle::StaticStruct())
+			{
+				TimerProperties->Emplace(*It);
+			}
+		}
+	}
+
+	for (const FStructProperty* PropertyIt : *TimerProperties)
+	{
+		// Timers paused by gameplay code are not touched, so they stay paused on take
+		const FTimerHandle& TimerHandle = *PropertyIt->ContainerPtrToValuePtr<FTimerHandle>(&Object);
+		if (TimerManager.IsTimerActive(TimerHandle)
+			|| TimerManager.IsTimerPending(TimerHandle))
+		{
+			TimerManager.PauseTimer(TimerHandle);
+			OutPausedTimers.AddUnique(TimerHandle);
+		}
+	}
+}
+
+/*********************************************************************************************
+ * Navigation
+ ********************************************************************************************* */
+
+// Removes components of given actor from navigation or adds them back
+void UPoolFactory_Actor::SetNavigationStateInPool(AActor& Actor, bool bActivate)
+{
+	if (!bNavigationNeutralInPool)
+	{
+		return;
+	}
+
+	if (bActivate)
+	{
+		// Is called on taking right after moving the actor, and again on activation when nothing is left to restore
+		TArray<TWeakObjectPtr<UActorComponent>> RemovedComponents;
+		if (!NavigationComponentsInternal.RemoveAndCopyValue(&Actor, RemovedComponents))
+		{
+			// Was never removed from navigation
+			return;
+		}
+
+		// Navigation octree is updated once for all components when the lock goes out of scope
+		FNavigationLockContext NavigationLock(Actor.GetWorld(), ENavigationLockReason::Unknown);
+		for (const TWeakObjectPtr<UActorComponent>& ComponentIt : RemovedComponents)
+		{
+			if (UActorComponent* Component = ComponentIt.Get())
+			{
+				Component->SetCanEverAffectNavigation(true);
+			}
+		}
+		return;
+	}
+
+	// Is called before moving the actor away and again on deactivation, already removed components are not relevant anymore
+	TArray<TWeakObjectPtr<UActorComponent>>& RemovedComponents = NavigationComponentsInternal.FindOrAdd(&Actor);
+	constexpr bool bIncludeFromChildActors = false;
+	Actor.ForEachComponent(bIncludeFromChildActors, [&RemovedComponents](UActorComponent* Component)
+	{
+		if (Component->CanEverAffectNavigation())
+		{
+			RemovedComponents.AddUnique(Component);
+			Component->SetCanEverAffectNavigation(false);
+		}
+	});
+}
+
+/*********************************************************************************************
+ * Component Reset
+ ********************************************************************************************* */
+
+// Adds the handler that resets all components of given class and its children of pooled actors
+void UPoolFactory_Actor::RegisterComponentResetHandler(TSubclassOf<UActorComponent> ComponentClass, FComponentResetHandler Handler)
+{
+	if (!ensureMsgf(ComponentClass, TEXT("ASSERT: [%i] %hs:\n'ComponentClass' is null!"), __LINE__, __FUNCTION__)
+		|| !ensureMsgf(Handler, TEXT("ASSERT: [%i] %hs:\n'Handler' is not set!"), __LINE__, __FUNCTION__))
+	{
+		return;
+	}
+
+	GetComponentResetHandlers().Add({ComponentClass, MoveTemp(Handler)});
+	++GetComponentResetHandlersVersion();
+}
+
+// Removes all handlers registered exactly for given component class, e.g: to replace built-in handler by own one
+void UPoolFactory_Actor::UnregisterComponentResetHandlers(TSubclassOf<UActorComponent> ComponentClass)
+{
+	const int32 RemovedNum = GetComponentResetHandlers().RemoveAll([ComponentClass](const FComponentResetHandlerEntry& EntryIt)
+	{
+		return EntryIt.ComponentClass == ComponentClass;
+	});
+
+	if (RemovedNum > 0)
+	{
+		++GetComponentResetHandlersVersion();
+	}
+}
+
+// Returns all registered handlers, built-in ones are registered on first call
+TArray<UPoolFactory_Actor::FComponentResetHandlerEntry>& UPoolFactory_Actor::GetComponentResetHandlers()
+{
+	static TArray<FComponentResetHandlerEntry> Handlers =
+	{
+		{UProjectileMovementComponent::StaticClass(), &ThisClass::ResetProjectileMovement},
+		{UAudioComponent::StaticClass(), &ThisClass::ResetAudio},
+		{UFXSystemComponent::StaticClass(), &ThisClass::ResetEffect},
+		{UDecalComponent::StaticClass(), &ThisClass::ResetDecal},
+		{UPrimitiveComponent::StaticClass(), &ThisClass::ResetPhysics},
+	};
+	return Handlers;
+}
+
+// Returns the version that is increased on each change of registered handlers
+uint32& UPoolFactory_Actor::GetComponentResetHandlersVersion()
+{
+	static uint32 Version = 0;
+	return Version;
+}
+
+// Returns cached indices of registered handlers that are applied to components of given actor class
+const TArray<int32>& UPoolFactory_Actor::GetComponentResetHandlersForActor(const AActor& Actor)
+{
+	const uint32 Version = GetComponentResetHandlersVersion();
+	if (ComponentResetHandlersVersionInternal != Version)
+	{
+		ComponentResetHandlersVersionInternal = Version;
+		ComponentResetHandlersByClassInternal.Empty();
+		ComponentResetBindingsInternal.Empty();
+	}
+
+	const UClass* ActorClass = Actor.GetClass();
+	if (const TArray<int32>* CachedIndices = ComponentResetHandlersByClassInternal.Find(ActorClass))
+	{
+		return *CachedIndices;
+	}
+
+	// Actors of the same class have the same components, so they are checked only for first actor of the class
+	TArray<int32>& HandlerIndices = ComponentResetHandlersByClassInternal.Add(ActorClass);
+	const TArray<FComponentResetHandlerEntry>& Handlers = GetComponentResetHandlers();
+	constexpr bool bIncludeFromChildActors = false;
+	Actor.ForEachComponent(bIncludeFromChildActors, [&HandlerIndices, &Handlers](const UActorComponent* Component)
+	{
+		for (int32 Index = 0; Index < Handlers.Num(); ++Index)
+		{
+			if (Component->IsA(Handlers[Index].ComponentClass))
+			{
+				HandlerIndices.AddUnique(Index);
+			}
+		}
+	});
+
+	return HandlerIndices;
+}
+
+// Returns cached components of given actor paired with registered handlers that are applied to them
+const TArray<UPoolFactory_Actor::FComponentResetBinding>& UPoolFactory_Actor::GetComponentResetBindings(const AActor& Actor)
+{
+	// Is called first, since it also drops all caches once any handler is (un)registered
+	const TArray<int32>& HandlerIndices = GetComponentResetHandlersForActor(Actor);
+
+	if (const TArray<FComponentResetBinding>* CachedBindings = ComponentResetBindingsInternal.Find(&Actor))
+	{
+		return *CachedBindings;
+	}
+
+	// Components are iterated only once per actor, only handlers of its class are checked
+	TArray<FComponentResetBinding>& Bindings = ComponentResetBindingsInternal.Add(&Actor);
+	const TArray<FComponentResetHandlerEntry>& Handlers = GetComponentResetHandlers();
+	constexpr bool bIncludeFromChildActors = false;
+	Actor.ForEachComponent(bIncludeFromChildActors, [&Bindings, &HandlerIndices, &Handlers](UActorComponent* Component)
+	{
+		for (const int32 Index : HandlerIndices)
+		{
+			if (Component->IsA(Handlers[Index].ComponentClass))
+			{
+				Bindings.Add({Component, Index});
+			}
+		}
+	});
+
+	return Bindings;
+}
+
+// Applies registered handlers to all components of given actor
+void UPoolFactory_Actor::ResetComponentsInPool(AActor& Actor, bool bActivate)
+{
+	if (!bResetComponentsInPool
+		|| GetComponentResetHandlersForActor(Actor).IsEmpty())
+	{
+		// Most actors have nothing to reset, so they are not cached at all
+		return;
+	}
+
+	const TArray<FComponentResetHandlerEntry>& Handlers = GetComponentResetHandlers();
+	for (const FComponentResetBinding& BindingIt : GetComponentResetBindings(Actor))
+	{
+		if (UActorComponent* Component = BindingIt.Component.Get())
+		{
+			Handlers[BindingIt.HandlerIndex].Handler(*Component, bActivate);
+		}
+	}
+}
+
+// Stops the projectile on return, and launches it again with its initial velocity on take
+void UPoolFactory_Actor::ResetProjectileMovement(UActorComponent& Component, bool bActivate)
+{
+	UProjectileMovementComponent& ProjectileMovement = static_cast<UProjectileMovementComponent&>(Component);
+	if (!bActivate)
+	{
+		ProjectileMovement.StopMovementImmediately();
+		ProjectileMovement.HomingTargetComponent = nullptr;
+		return;
+	}
+
+	// Updated component is cleared by stopping simulation on previous hit
+	if (!ProjectileMovement.UpdatedComponent)
+	{
+		ProjectileMovement.SetUpdatedComponent(Component.GetOwner()->GetRootComponent());
+	}
+
+	// Velocity is initialized in the same way as the engine does on component initialization
+	const UProjectileMovementComponent* Archetype = Cast<UProjectileMovementComponent>(ProjectileMovement.GetArchetype());
+	FVector Velocity = Archetype ? Archetype->Velocity : ProjectileMovement.Velocity;
+	if (ProjectileMovement.InitialSpeed > 0.f)
+	{
+		Velocity = Velocity.GetSafeNormal() * ProjectileMovement.InitialSpeed;
+	}
+
+	if (ProjectileMovement.bInitialVelocityInLocalSpace)
+	{
+		ProjectileMovement.SetVelocityInLocalSpace(Velocity);
+	}
+	else
+	{
+		ProjectileMovement.Velocity = Velocity;
+	}
+
+	ProjectileMovement.UpdateComponentVelocity();
+}
+
+// Stops the sound on return, and plays it again on take if it is auto activated
+void UPoolFactory_Actor::ResetAudio(UActorComponent& Component, bool bActivate)
+{
+	UAudioComponent& Audio = static_cast<UAudioComponent&>(Component);
+	Audio.Stop();
+
+	if (bActivate
+		&& Audio.bAutoActivate)
+	{
+		Audio.Play();
+	}
+}
+
+// Clears particles and Niagara effects on return, and restarts them on take if they are auto activated
+void UPoolFactory_Actor::ResetEffect(UActorComponent& Component, bool bActivate)
+{
+	UFXSystemComponent& Effect = static_cast<UFXSystemComponent&>(Component);
+	Effect.DeactivateImmediate();
+
+	if (bActivate
+		&& Effect.bAutoActivate)
+	{
+		constexpr bool bReset = true;
+		Effect.Activate(bReset);
+	}
+}
+
+// Restarts fading of the decal on take
+void UPoolFactory_Actor::ResetDecal(UActorComponent& Component, bool bActivate)
+{
+	if (!bActivate)
+	{
+		return;
+	}
+
+	UDecalComponent& Decal = static_cast<UDecalComponent&>(Component);
+	if (Decal.FadeInDuration > 0.f)
+	{
+		Decal.SetFadeIn(Decal.FadeInStartDelay, Decal.FadeInDuration);
+	}
+
+	if (Decal.FadeDuration > 0.f)
+	{
+		Decal.SetFadeOut(Decal.FadeStartDelay, Decal.FadeDuration, Decal.bDestroyOwnerAfterFade);
+	}
+}
+
+// Stops simulated bodies, they sleep while in the pool and are woken up on take
+void UPoolFactory_Actor::ResetPhysics(UActorComponent& Component, bool bActivate)
+{
+	UPrimitiveComponent& Primitive = static_cast<UPrimitiveComponent&>(Component);
+	if (!Primitive.IsSimulatingPhysics())
+	{
+		return;
+	}
+
+	Primitive.SetPhysicsLinearVelocity(FVector::ZeroVector);
+	Primitive.SetPhysicsAngularVelocityInDegrees(FVector::ZeroVector);
+
+	if (bActivate)
+	{
+		Primitive.WakeAllRigidBodies();
+	}
+	else
+	{
+		Primitive.PutAllRigidBodiesToSleep();
+	}
+}
+
+/*********************************************************************************************
+ * Skeletal Meshes
+ ********************************************************************************************* */
+
+// Pauses or resumes animation, bone updates and cloth of all skeletal meshes of given actor
+void UPoolFactory_Actor::SetSkeletalMeshesStateInPool(AActor& Actor, bool bActivate)
+{
+	if (!bKeepAnimationWarmInPool)
+	{
+		return;
+	}
+
+	constexpr bool bIncludeFromChildActors = false;
+	Actor.ForEachComponent<USkeletalMeshComponent>(bIncludeFromChildActors, [this, bActivate](USkeletalMeshComponent* SkeletalMesh)
+	{
+		if (!bActivate)
+		{
+			// Animation instance is not touched, so it keeps its state and is not initialized again on taking
+			// Is recorded only once, so suspending already suspended mesh does not overwrite its state
+			if (!SkeletalMeshStatesInternal.Contains(SkeletalMesh))
+			{
+				FPoolSkeletalMeshState& SavedState = SkeletalMeshStatesInternal.Add(SkeletalMesh);
+				SavedState.bWasTickEnabled = SkeletalMesh->IsComponentTickEnabled();
+				SavedState.bWasAnimPaused = SkeletalMesh->bPauseAnims;
+				SavedState.bWasSkeletonUpdateDisabled = SkeletalMesh->bNoSkeletonUpdate;
+			}
+
+			SkeletalMesh->bPauseAnims = true;
+			SkeletalMesh->bNoSkeletonUpdate = true;
+			SkeletalMesh->SetComponentTickEnabled(false);
+			SkeletalMesh->SuspendClothingSimulation();
+			return;
+		}
+
+		FPoolSkeletalMeshState SavedState;
+		if (!SkeletalMeshStatesInternal.RemoveAndCopyValue(SkeletalMesh, SavedState))
+		{
+			// Was never returned to the pool, so nothing to restore
+			return;
+		}
+
+		SkeletalMesh->bPauseAnims = SavedState.bWasAnimPaused;
+		SkeletalMesh->bNoSkeletonUpdate = SavedState.bWasSkeletonUpdateDisabled;
+		SkeletalMesh->SetComponentTickEnabled(SavedState.bWasTickEnabled);
+
+		// The actor was teleported from the parking location, so cloth starts from the new pose instead of flying over the level
+		SkeletalMesh->ResumeClothingSimulation();
+		SkeletalMesh->ForceClothNextUpdateTeleportAndReset();
+
+		// Evaluate the pose once right away, so the first rendered frame does not show the pose of the last use
+		if (!SavedState.bWasSkeletonUpdateDisabled)
+		{
+			constexpr float DeltaTime = 0.f;
+			constexpr bool bNeedsValidRootMotion = false;
+			SkeletalMesh->TickAnimation(DeltaTime, bNeedsValidRootMotion);
+			SkeletalMesh->RefreshBoneTransforms();
+		}
+	});
+}
+
+/*********************************************************************************************
+ * Instanced Proxy
+ ********************************************************************************************* */
+
+// Starts rendering taken actors of given class and its children as instances, is applied to already taken actors on their next take
+void UPoolFactory_Actor::EnableInstancedProxy(TSubclassOf<AActor> ActorClass)
+{
+	if (ensureMsgf(ActorClass, TEXT("ASSERT: [%i] %hs:\n'ActorClass' is null!"), __LINE__, __FUNCTION__))
+	{
+		InstancedProxyClasses.AddUnique(ActorClass);
+	}
+}
+
+// Stops rendering actors of given class as instances, all of them are promoted right away
+void UPoolFactory_Actor::DisableInstancedProxy(TSubclassOf<AActor> ActorClass)
+{
+	if (!InstancedProxyClasses.Remove(ActorClass))
+	{
+		return;
+	}
+
+	TArray<AActor*> ActorsToPromote;
+	for (const TTuple<TObjectKey<AActor>, FPoolProxySlot>& It : ProxySlotsInternal)
+	{
+		AActor* Actor = It.Key.ResolveObjectPtr();
+		if (Actor
+			&& !IsInstancedProxyEnabled(Actor->GetClass()))
+		{
+			ActorsToPromote.Emplace(Actor);
+		}
+	}
+
+	for (AActor* ActorIt : ActorsToPromote)
+	{
+		PromoteActor(ActorIt);
+	}
+}
+
+// Returns true if taken actors of given class are rendered as instances
+bool UPoolFactory_Actor::IsInstancedProxyEnabled(const UClass* ActorClass) const
+{
+	if (!ActorClass)
+	{
+		return false;
+	}
+
+	for (const TSubclassOf<AActor>& ClassIt : InstancedProxyClasses)
+	{
+		if (ClassIt
+			&& ActorClass->IsChildOf(ClassIt))
+		{
+			return true;
+		}
+	}
+
+	return false;
+}
+
+// Shows own static mesh of given taken actor instead of its instance
+void UPoolFactory_Actor::PromoteActor(AActor* Actor)
+{
+	if (Actor)
+	{
+		ReleaseProxySlot(*Actor);
+	}
+}
+
+// Returns the static mesh of given actor that is replaced by instance: its root or the first one
+UStaticMeshComponent* UPoolFactory_Actor::GetProxiedMesh(const AActor& Actor)
+{
+	UStaticMeshComponent* RootMesh = Cast<UStaticMeshComponent>(Actor.GetRootComponent());
+	if (RootMesh
+		&& !RootMesh->IsA<UInstancedStaticMeshComponent>())
+	{
+		return RootMesh;
+	}
+
+	UStaticMeshComponent* FoundMesh = nullptr;
+	constexpr bool bIncludeFromChildActors = false;
+	Actor.ForEachComponent<UStaticMeshComponent>(bIncludeFromChildActors, [&FoundMesh](UStaticMeshComponent* MeshIt)
+	{
+		if (!FoundMesh
+			&& !MeshIt->IsA<UInstancedStaticMeshComponent>())
+		{
+			FoundMesh = MeshIt;
+		}
+	});
+
+	return FoundMesh;
+}
+
+// Returns instanced mesh of given actor class, creates it on first call by given source mesh
+UInstancedStaticMeshComponent* UPoolFactory_Actor::GetOrCreateInstancedMesh(const UClass* ActorClass, const UStaticMeshComponent& SourceMesh)
+{
+	FPoolInstancedProxy& Proxy = InstancedProxiesInternal.FindOrAdd(ActorClass);
+	if (UInstancedStaticMeshComponent* InstancedMesh = Proxy.InstancedMesh.Get())
+	{
+		return InstancedMesh;
+	}
+
+	// Host or its meshes were destroyed, e.g: by streaming out, so all slots are not valid anymore
+	Proxy.SlotActors.Empty();
+	Proxy.FreeSlots.Empty();
+
+	if (!IsValid(InstancedProxiesHostInternal))
+	{
+		UWorld* World = GetWorld();
+		checkf(World, TEXT("ERROR: [%i] %hs:\n'World' is null!"), __LINE__, __FUNCTION__);
+
+		FActorSpawnParameters SpawnParameters;
+		SpawnParameters.OverrideLevel = World->PersistentLevel; // Always keep instances on Persistent level as pooled actors are
+		SpawnParameters.ObjectFlags |= RF_Transient;
+#if WITH_EDITORONLY_DATA
+		SpawnParameters.bCreateActorPackage = false; // Do not bake this runtime actor into World Partition level
+#endif
+		InstancedProxiesHostInternal = World->SpawnActor<AActor>(AActor::StaticClass(), FTransform::Identity, SpawnParameters);
+
+		USceneComponent* HostRoot = NewObject<USceneComponent>(InstancedProxiesHostInternal, NAME_None, RF_Transient);
+		InstancedProxiesHostInternal->SetRootComponent(HostRoot);
+		HostRoot->RegisterComponent();
+	}
+
+	UInstancedStaticMeshComponent* InstancedMesh = NewObject<UInstancedStaticMeshComponent>(InstancedProxiesHostInternal, NAME_None, RF_Transient);
+	InstancedMesh->SetMobility(EComponentMobility::Movable);
+	InstancedMesh->SetStaticMesh(SourceMesh.GetStaticMesh());
+	for (int32 MaterialIndex = 0; MaterialIndex < SourceMesh.GetNumMaterials(); ++MaterialIndex)
+	{
+		InstancedMesh->SetMaterial(MaterialIndex, SourceMesh.GetMaterial(MaterialIndex));
+	}
+
+	// Instances are visuals only, collision and navigation are kept by the actors themselves
+	InstancedMesh->SetCollisionEnabled(ECollisionEnabled::NoCollision);
+	InstancedMesh->SetCanEverAffectNavigation(false);
+	InstancedMesh->SetCastShadow(SourceMesh.CastShadow);
+
+	InstancedMesh->SetupAttachment(InstancedProxiesHostInternal->GetRootComponent());
+	InstancedMesh->RegisterComponent();
+	InstancedProxiesHostInternal->AddInstanceComponent(InstancedMesh);
+
+	Proxy.InstancedMesh = InstancedMesh;
+	return InstancedMesh;
+}
+
+// Replaces own static mesh of given actor by instance on taking, or frees its instance on returning
+void UPoolFactory_Actor::SetInstancedProxyStateInPool(AActor& Actor, bool bActivate)
+{
+	if (!bActivate)
+	{
+		ReleaseProxySlot(Actor);
+		return;
+	}
+
+	if (InstancedProxyClasses.IsEmpty()
+		|| ProxySlotsInternal.Contains(&Actor)
+		|| !IsInstancedProxyEnabled(Actor.GetClass()))
+	{
+		return;
+	}
+
+	UStaticMeshComponent* ProxiedMesh = GetProxiedMesh(Actor);
+	if (!ProxiedMesh
+		|| !ProxiedMesh->GetStaticMesh())
+	{
+		// Nothing to render as instance, so the actor stays as is
+		return;
+	}
+
+	UInstancedStaticMeshComponent* InstancedMesh = GetOrCreateInstancedMesh(Actor.GetClass(), *ProxiedMesh);
+	FPoolInstancedProxy& Proxy = InstancedProxiesInternal.FindChecked(Actor.GetClass());
+
+	// Slots are reused instead of removing instances, so indices of other instances are never shifted
+	const FTransform& MeshTransform = ProxiedMesh->GetComponentTransform();
+	constexpr bool bWorldSpace = true;
+	int32 Slot = INDEX_NONE;
+	if (!Proxy.FreeSlots.IsEmpty())
+	{
+		Slot = Proxy.FreeSlots.Pop(EAllowShrinking::No);
+		Proxy.SlotActors[Slot] = &Actor;
+
+		constexpr bool bMarkRenderStateDirty = false;
+		constexpr bool bTeleport = true;
+		InstancedMesh->UpdateInstanceTransform(Slot, MeshTransform, bWorldSpace, bMarkRenderStateDirty, bTeleport);
+		MarkInstancedMeshDirty(*InstancedMesh);
+	}
+	else
+	{
+		Slot = InstancedMesh->AddInstance(MeshTransform, bWorldSpace);
+		Proxy.SlotActors.SetNum(FMath::Max(Proxy.SlotActors.Num(), Slot + 1));
+		Proxy.SlotActors[Slot] = &Actor;
+	}
+
+	FPoolProxySlot& ProxySlot = ProxySlotsInternal.Add(&Actor);
+	ProxySlot.Slot = Slot;
+	ProxySlot.bWasMeshVisible = ProxiedMesh->IsVisible();
+
+	// Own mesh is hidden to have no scene proxy, but its collision is kept
+	constexpr bool bPropagateToChildren = false;
+	ProxiedMesh->SetVisibility(false, bPropagateToChildren);
+	ProxiedMesh->TransformUpdated.AddUObject(this, &ThisClass::OnProxiedMeshMoved);
+}
+
+// Frees the instance of given actor and restores visibility of its own static mesh, does nothing if it is not rendered as instance
+void UPoolFactory_Actor::ReleaseProxySlot(AActor& Actor)
+{
+	FPoolProxySlot ProxySlot;
+	if (!ProxySlotsInternal.RemoveAndCopyValue(&Actor, ProxySlot))
+	{
+		return;
+	}
+
+	const int32 Slot = ProxySlot.Slot;
+	if (UStaticMeshComponent* ProxiedMesh = GetProxiedMesh(Actor))
+	{
+		ProxiedMesh->TransformUpdated.RemoveAll(this);
+
+		// Mesh that was hidden by gameplay code before it was rendered as instance stays hidden
+		constexpr bool bPropagateToChildren = false;
+		ProxiedMesh->SetVisibility(ProxySlot.bWasMeshVisible, bPropagateToChildren);
+	}
+
+	FPoolInstancedProxy* Proxy = InstancedProxiesInternal.Find(Actor.GetClass());
+	UInstancedStaticMeshComponent* InstancedMesh = Proxy ? Proxy->InstancedMesh.Get() : nullptr;
+	if (!InstancedMesh
+		|| !Proxy->SlotActors.IsValidIndex(Slot))
+	{
+		return;
+	}
+
+	// Free instance is collapsed instead of removing, so the slot is reused by next taken actor
+	Proxy->SlotActors[Slot] = nullptr;
+	Proxy->FreeSlots.Emplace(Slot);
+
+	// Is collapsed where it was, moving it far away would stretch the bounds of all instances to the world edge
+	constexpr bool bWorldSpace = true;
+	FTransform FreeTransform = FTransform::Identity;
+	InstancedMesh->GetInstanceTransform(Slot, FreeTransform, bWorldSpace);
+	FreeTransform.SetScale3D(FVector::ZeroVector);
+
+	constexpr bool bMarkRenderStateDirty = false;
+	constexpr bool bTeleport = true;
+	InstancedMesh->UpdateInstanceTransform(Slot, FreeTransform, bWorldSpace, bMarkRenderStateDirty, bTeleport);
+
+	MarkInstancedMeshDirty(*InstancedMesh);
+}
+
+// Is called when proxied static mesh of any actor is moved to move its instance as well
+void UPoolFactory_Actor::OnProxiedMeshMoved(USceneComponent* UpdatedComponent, EUpdateTransformFlags UpdateTransformFlags, ETeleportType Teleport)
+{
+	AActor* Actor = UpdatedComponent ? UpdatedComponent->GetOwner() : nullptr;
+	const FPoolProxySlot* ProxySlot = Actor ? ProxySlotsInternal.Find(Actor) : nullptr;
+	const FPoolInstancedProxy* Proxy = ProxySlot ? InstancedProxiesInternal.Find(Actor->GetClass()) : nullptr;
+	UInstancedStaticMeshComponent* InstancedMesh = Proxy ? Proxy->InstancedMesh.Get() : nullptr;
+	if (!InstancedMesh)
+	{
+		return;
+	}
+
+	// Render state is updated once per frame for all moved instances
+	constexpr bool bWorldSpace = true;
+	constexpr bool bMarkRenderStateDirty = false;
+	const bool bTeleport = Teleport != ETeleportType::None;
+	InstancedMesh->UpdateInstanceTransform(ProxySlot->Slot, UpdatedComponent->GetComponentTransform(), bWorldSpace, bMarkRenderStateDirty, bTeleport);
+
+	MarkInstancedMeshDirty(*InstancedMesh);
+}
+
+// Updates render state of given instanced mesh once on next tick, no matter how many of its instances are moved this frame
+void UPoolFactory_Actor::MarkInstancedMeshDirty(UInstancedStaticMeshComponent& InstancedMesh)
+{
+	const bool bIsAlreadyPending = !DirtyInstancedMeshesInternal.IsEmpty();
+	DirtyInstancedMeshesInternal.AddUnique(&InstancedMesh);
+	const UWorld* World = GetWorld();
+	if (!bIsAlreadyPending
+		&& World)
+	{
+		World->GetTimerManager().SetTimerForNextTick(this, &ThisClass::OnNextTickUpdateInstancedMeshes);
+	}
+}
+
+// Updates render state of all instanced meshes which instances were moved last frame
+void UPoolFactory_Actor::OnNextTickUpdateInstancedMeshes()
+{
+	TArray<TWeakObjectPtr<UInstancedStaticMeshComponent>> DirtyMeshes = MoveTemp(DirtyInstancedMeshesInternal);
+	for (const TWeakObjectPtr<UInstancedStaticMeshComponent>& MeshIt : DirtyMeshes)
+	{
+		if (UInstancedStaticMeshComponent* InstancedMesh = MeshIt.Get())
+		{
+			InstancedMesh->MarkRenderStateDirty();
+		}
+	}
+}
+
+/*********************************************************************************************
+ * Network
+ ********************************************************************************************* */
+
+// Returns true if given actor is replicated by this server and can be put into network dormancy while it is in the pool
+bool UPoolFactory_Actor::CanBeDormantInPool(const AActor* Actor) const
+{
+	if (!bUseNetDormancyInPool
+		|| !Actor
+		|| !Actor->GetIsReplicated()
+		|| !Actor->HasAuthority()
+		|| Actor->GetNetMode() == NM_Standalone
+		|| Actor->GetNetMode() == NM_Client) // Client's stand-ins are not replicated
+	{
+		return false;
+	}
+
+	// Respect actors that are designed to never go dormant
+	const AActor* ActorCDO = Actor->GetClass()->GetDefaultObject<AActor>();
+	return ActorCDO && ActorCDO->NetDormancy != DORM_Never;
+}
+
+// Puts given actor into full dormancy, is called when actor is returned and all its changes are done
+void UPoolFactory_Actor::EnterNetDormancy(AActor& Actor)
+{
+	if (!CanBeDormantInPool(&Actor))
+	{
+		return;
+	}
+
+	// Replicate hidden state as soon as possible, then the channel is closed as dormant and is not considered by the net driver anymore
+	Actor.ForceNetUpdate();
+	Actor.SetNetDormancy(DORM_DormantAll);
+}
+
+// Flushes dormancy and restores default one of given actor, is called before actor's changes on taking from pool
+void UPoolFactory_Actor::LeaveNetDormancy(AActor& Actor)
+{
+	if (!CanBeDormantInPool(&Actor))
+	{
+		return;
+	}
+
+	const ENetDormancy DefaultDormancy = Actor.GetClass()->GetDefaultObject<AActor>()->NetDormancy;
+	if (DefaultDormancy == DORM_Awake
+		|| DefaultDormancy == DORM_Initial)
+	{
+		Actor.SetNetDormancy(DORM_Awake);
+	}
+	else
+	{
+		// Class is dormant by design, keep its dormancy, but flush it to replicate activation
+		Actor.SetNetDormancy(DefaultDormancy);
+		Actor.FlushNetDormancy();
+	}
 }
@@ -0,0 +1,408 @@
+﻿// Copyright (c) Yevhenii Selivanov
+
+#include "Factories/PoolFactory_MaterialInstanceDynamic.h"
+//---
+#include "PoolManagerSubsystem.h"
+#include "Data/PoolManagerSettings.h"
+//---
+#include "Engine/Texture.h"
+#include "Materials/MaterialInstanceDynamic.h"
+//---
+#include UE_INLINE_GENERATED_CPP_BY_NAME(PoolFactory_MaterialInstanceDynamic)
+
+// Is overridden to handle Material Instance Dynamics
+const UClass* UPoolFactory_MaterialInstanceDynamic::GetObjectClass_Implementation() const
+{
+	return UMaterialInstanceDynamic::StaticClass();
+}
+
+// Returns the payload to take Material Instance Dynamic of given parent material from the pool
+FInstancedStruct UPoolFactory_MaterialInstanceDynamic::MakePayload(UMaterialInterface* ParentMaterial)
+{
+	FPoolMaterialPayload MaterialPayload;
+	MaterialPayload.ParentMaterial = ParentMaterial;
+	return FInstancedStruct::Make(MaterialPayload);
+}
+
+// Returns the parent material from given payload, is null if the payload is not FPoolMaterialPayload
+UMaterialInterface* UPoolFactory_MaterialInstanceDynamic::GetParentMaterial(const FInstancedStruct& Payload)
+{
+	const FPoolMaterialPayload* MaterialPayload = Payload.GetPtr<FPoolMaterialPayload>();
+	return MaterialPayload ? MaterialPayload->ParentMaterial : nullptr;
+}
+
+// Is overridden to listen for changes of parent materials in editor
+void UPoolFactory_MaterialInstanceDynamic::PostInitProperties()
+{
+	Super::PostInitProperties();
+
+#if WITH_EDITOR
+	if (!HasAnyFlags(RF_ClassDefaultObject))
+	{
+		FCoreUObjectDelegates::OnObjectPropertyChanged.AddUObject(this, &ThisClass::OnObjectPropertyChanged);
+	}
+#endif // WITH_EDITOR
+}
+
+// Is overridden to stop listening for changes of parent materials and clear cached values
+void UPoolFactory_MaterialInstanceDynamic::BeginDestroy()
+{
+#if WITH_EDITOR
+	FCoreUObjectDelegates::OnObjectPropertyChanged.RemoveAll(this);
+#endif // WITH_EDITOR
+
+	ParentValuesInternal.Empty();
+	SubPoolsInternal.Empty();
+
+	Super::BeginDestroy();
+}
+
+/*********************************************************************************************
+ * Creation
+ ********************************************************************************************* */
+
+// Is overridden to reject requests with no parent material in the payload
+bool UPoolFactory_MaterialInstanceDynamic::CanSpawn(const FSpawnRequest& Request) const
+{
+	if (!GetParentMaterial(Request.Payload))
+	{
+		UE_LOG(LogPoolManager, Error, TEXT("Material Instance Dynamic can't be created with no parent material, pass UPoolFactory_MaterialInstanceDynamic::MakePayload() on taking it"));
+		return false;
+	}
+
+	return Super::CanSpawn(Request);
+}
+
+// Is overridden to count misses of the sub-pool of requested parent material
+void UPoolFactory_MaterialInstanceDynamic::RequestSpawn_Implementation(const FSpawnRequest& Request)
+{
+	const UMaterialInterface* ParentMaterial = GetParentMaterial(Request.Payload);
+	if (ParentMaterial
+		&& !Request.bIsPrewarm)
+	{
+		// Is taken while the sub-pool has no free materials
+		++SubPoolsInternal.FindOrAdd(ParentMaterial).MissesNum;
+	}
+
+	Super::RequestSpawn_Implementation(Request);
+}
+
+// Is overridden to create Material Instance Dynamic of the parent material from request's payload
+UObject* UPoolFactory_MaterialInstanceDynamic::SpawnNow_Implementation(const FSpawnRequest& Request)
+{
+	// Super is not called to create it with its parent material
+
+	UMaterialInterface* ParentMaterial = GetParentMaterial(Request.Payload);
+	checkf(ParentMaterial, TEXT("ERROR: [%i] %hs:\n'ParentMaterial' is null, the request had to be rejected by CanSpawn()!"), __LINE__, __FUNCTION__);
+
+	return UMaterialInstanceDynamic::Create(ParentMaterial, GetOuter());
+}
+
+/*********************************************************************************************
+ * Destruction
+ ********************************************************************************************* */
+
+// Is overridden to remove destroyed material from its sub-pool
+void UPoolFactory_MaterialInstanceDynamic::Destroy_Implementation(UObject* Object)
+{
+	UMaterialInstanceDynamic* Material = CastChecked<UMaterialInstanceDynamic>(Object);
+	if (FPoolMaterialSubPool* SubPool = SubPoolsInternal.Find(Material->Parent.Get()))
+	{
+		SubPool->Materials.Remove(Material);
+		SubPool->FreeMaterials.Remove(Material);
+
+		if (SubPool->Materials.IsEmpty())
+		{
+			// Values are not needed anymore and could be outdated once the parent is used again
+			ParentValuesInternal.Remove(Material->Parent.Get());
+		}
+	}
+
+	Super::Destroy_Implementation(Object);
+}
+
+/*********************************************************************************************
+ * Pool
+ ********************************************************************************************* */
+
+// Is overridden to take only Material Instance Dynamics of the parent material from given payload
+bool UPoolFactory_MaterialInstanceDynamic::CanTakeFromPool(const UObject* Object, const FInstancedStruct& Payload) const
+{
+	const UMaterialInstanceDynamic* Material = CastChecked<UMaterialInstanceDynamic>(Object);
+	return Super::CanTakeFromPool(Object, Payload)
+		&& Material->Parent == GetParentMaterial(Payload);
+}
+
+// Is overridden to take free material from the sub-pool of the parent material from given payload instead of looking through the whole pool
+FPoolObjectData* UPoolFactory_MaterialInstanceDynamic::FindFreeObject(FPoolContainer& Pool, const FInstancedStruct& Payload)
+{
+	// Super is not called to avoid looking through materials of all parents
+
+	FPoolMaterialSubPool* SubPool = SubPoolsInternal.Find(GetParentMaterial(Payload));
+	if (!SubPool)
+	{
+		return nullptr;
+	}
+
+	for (auto It = SubPool->FreeMaterials.CreateIterator(); It; ++It)
+	{
+		const UMaterialInstanceDynamic* Material = It->Get();
+		FPoolObjectData* FoundData = Material ? Pool.FindInPool(*Material) : nullptr;
+
+		// Is removed even if it's stale, so the sub-pool does not keep destroyed or already taken materials
+		It.RemoveCurrent();
+
+		if (FoundData
+			&& FoundData->IsFree()
+			&& CanTakeFromPool(Material, Payload))
+		{
+			++SubPool->HitsNum;
+			return FoundData;
+		}
+	}
+
+	return nullptr;
+}
+
+// Is overridden to keep sub-pools of parent materials up to date
+void UPoolFactory_MaterialInstanceDynamic::OnChangedStateInPool_Implementation(EPoolObjectState NewState, UObject* InObject)
+{
+	Super::OnChangedStateInPool_Implementation(NewState, InObject);
+
+	UMaterialInstanceDynamic* Material = Cast<UMaterialInstanceDynamic>(InObject);
+	if (!Material
+		|| !Material->Parent)
+	{
+		return;
+	}
+
+	FPoolMaterialSubPool& SubPool = SubPoolsInternal.FindOrAdd(Material->Parent.Get());
+	SubPool.Materials.Add(Material);
+
+	if (NewState == EPoolObjectState::Inactive)
+	{
+		SubPool.FreeMaterials.Add(Material);
+	}
+	else
+	{
+		SubPool.FreeMaterials.Remove(Material);
+	}
+}
+
+// Is overridden to reset overridden parameters to values of the parent material
+void UPoolFactory_MaterialInstanceDynamic::OnReturnToPool_Implementation(UObject* Object)
+{
+	Super::OnReturnToPool_Implementation(Object);
+
+	ResetToParentValues(*CastChecked<UMaterialInstanceDynamic>(Object));
+}
+
+/*********************************************************************************************
+ * Sub-Pools
+ ********************************************************************************************* */
+
+// Returns number of registered materials of given parent material, both active and free
+int32 UPoolFactory_MaterialInstanceDynamic::GetMaterialsNum(const UMaterialInterface* ParentMaterial) const
+{
+	const FPoolMaterialSubPool* SubPool = FindSubPool(ParentMaterial);
+	return SubPool ? SubPool->Materials.Num() : 0;
+}
+
+// Returns number of free materials of given parent material
+int32 UPoolFactory_MaterialInstanceDynamic::GetFreeMaterialsNum(const UMaterialInterface* ParentMaterial) const
+{
+	const FPoolMaterialSubPool* SubPool = FindSubPool(ParentMaterial);
+	return SubPool ? SubPool->FreeMaterials.Num() : 0;
+}
+
+// Creates free materials of given parent next frames in advance, so they are ready to be taken with no spawn
+int32 UPoolFactory_MaterialInstanceDynamic::PrewarmMaterials(UMaterialInterface* ParentMaterial, int32 Amount, ESpawnRequestPriority Priority/* = ESpawnRequestPriority::Normal*/)
+{
+	UPoolManagerSubsystem* PoolManager = GetPoolManager();
+	if (!ensureMsgf(ParentMaterial, TEXT("ASSERT: [%i] %hs:\n'ParentMaterial' is null!"), __LINE__, __FUNCTION__)
+		|| !PoolManager)
+	{
+		return 0;
+	}
+
+	// Scale by current scalability the same as the Pool Manager does for whole pools
+	Amount = FMath::CeilToInt32(Amount * UPoolManagerSettings::Get().GetPrewarmMultiplier());
+
+	int32 ExistingNum = GetMaterialsNum(ParentMaterial);
+	for (const FSpawnRequest& RequestIt : GetSpawnQueue())
+	{
+		ExistingNum += GetParentMaterial(RequestIt.Payload) == ParentMaterial ? 1 : 0;
+	}
+
+	const int32 NewNum = Amount - ExistingNum;
+	if (NewNum <= 0)
+	{
+		// Already contains enough materials
+		return 0;
+	}
+
+	const FInstancedStruct Payload = MakePayload(ParentMaterial);
+	TArray<FSpawnRequest> Requests;
+	FSpawnRequest::MakeRequests(/*out*/Requests, GetObjectClass(), NewNum, Priority);
+	for (FSpawnRequest& RequestIt : Requests)
+	{
+		RequestIt.Payload = Payload;
+		RequestIt.bIsPrewarm = true;
+	}
+
+	TArray<FPoolObjectHandle> Handles;
+	PoolManager->CreateNewObjectsArrayInPool(Requests, /*out*/Handles);
+
+	return NewNum;
+}
+
+// Destroys free materials of given parent right away until its sub-pool contains specified amount of them
+void UPoolFactory_MaterialInstanceDynamic::ShrinkMaterials(UMaterialInterface* ParentMaterial, int32 Amount)
+{
+	UPoolManagerSubsystem* PoolManager = GetPoolManager();
+	const FPoolMaterialSubPool* SubPool = FindSubPool(ParentMaterial);
+	if (!PoolManager
+		|| !SubPool)
+	{
+		return;
+	}
+
+	int32 ExcessNum = SubPool->Materials.Num() - FMath::Max(Amount, 0);
+	TSet<const UObject*> MaterialsToDestroy;
+	for (const TWeakObjectPtr<UMaterialInstanceDynamic>& MaterialIt : SubPool->FreeMaterials)
+	{
+		if (ExcessNum <= 0)
+		{
+			break;
+		}
+
+		if (const UMaterialInstanceDynamic* Material = MaterialIt.Get())
+		{
+			MaterialsToDestroy.Add(Material);
+			--ExcessNum;
+		}
+	}
+
+	if (MaterialsToDestroy.IsEmpty())
+	{
+		return;
+	}
+
+	// Destroyed materials are removed from the sub-pool by Destroy()
+	PoolManager->EmptyAllByPredicate([&MaterialsToDestroy](const UObject* PoolObject)
+	{
+		return MaterialsToDestroy.Contains(PoolObject);
+	});
+}
+
+/*********************************************************************************************
+ * Parent Values
+ ********************************************************************************************* */
+
+// Sets only overridden parameters of given material back to values of its parent
+void UPoolFactory_MaterialInstanceDynamic::ResetToParentValues(UMaterialInstanceDynamic& Material)
+{
+	if (Material.ScalarParameterValues.IsEmpty()
+		&& Material.VectorParameterValues.IsEmpty()
+		&& Material.TextureParameterValues.IsEmpty())
+	{
+		// Nothing was overridden
+		return;
+	}
+
+	const UMaterialInterface* Parent = Material.Parent;
+	if (!Parent)
+	{
+		Material.ClearParameterValues();
+		return;
+	}
+
+	// Overridden parameters are kept with parent values instead of clearing all of them,
+	// so render resources are not initialized again and the same parameters are set in place on next use
+	FPoolMaterialParentValues& ParentValues = ParentValuesInternal.FindOrAdd(Parent);
+
+	for (int32 Index = 0; Index < Material.ScalarParameterValues.Num(); ++Index)
+	{
+		const FMaterialParameterInfo ParameterInfo = Material.ScalarParameterValues[Index].ParameterInfo;
+		const bool bIsGlobal = ParameterInfo.Association == EMaterialParameterAssociation::GlobalParameter;
+		const float* CachedValue = bIsGlobal ? ParentValues.Scalars.Find(ParameterInfo.Name) : nullptr;
+		float ParentValue = CachedValue ? *CachedValue : 0.f;
+		if (!CachedValue)
+		{
+			if (!Parent->GetScalarParameterValue(ParameterInfo, /*out*/ParentValue))
+			{
+				continue;
+			}
+
+			if (bIsGlobal)
+			{
+				ParentValues.Scalars.Add(ParameterInfo.Name, ParentValue);
+			}
+		}
+
+		Material.SetScalarParameterValueByInfo(ParameterInfo, ParentValue);
+	}
+
+	for (int32 Index = 0; Index < Material.VectorParameterValues.Num(); ++Index)
+	{
+		const FMaterialParameterInfo ParameterInfo = Material.VectorParameterValues[Index].ParameterInfo;
+		const bool bIsGlobal = ParameterInfo.Association == EMaterialParameterAssociation::GlobalParameter;
+		const FLinearColor* CachedValue = bIsGlobal ? ParentValues.Vectors.Find(ParameterInfo.Name) : nullptr;
+		FLinearColor ParentValue = CachedValue ? *CachedValue : FLinearColor::Black;
+		if (!CachedValue)
+		{
+			if (!Parent->GetVectorParameterValue(ParameterInfo, /*out*/ParentValue))
+			{
+				continue;
+			}
+
+			if (bIsGlobal)
+			{
+				ParentValues.Vectors.Add(ParameterInfo.Name, ParentValue);
+			}
+		}
+
+		Material.SetVectorParameterValueByInfo(ParameterInfo, ParentValue);
+	}
+
+	for (int32 Index = 0; Index < Material.TextureParameterValues.Num(); ++Index)
+	{
+		const FMaterialParameterInfo ParameterInfo = Material.TextureParameterValues[Index].ParameterInfo;
+		const bool bIsGlobal = ParameterInfo.Association == EMaterialParameterAssociation::GlobalParameter;
+		const FPoolMaterialTextureValue* CachedValue = bIsGlobal ? ParentValues.Textures.Find(ParameterInfo.Name) : nullptr;
+		UTexture* ParentValue = CachedValue ? CachedValue->Texture.Get() : nullptr;
+		if (!CachedValue
+			|| CachedValue->Texture.IsStale())
+		{
+			// Null texture of the parent is cached as well, so it's not looked up on each return
+			const bool bIsResolved = Parent->GetTextureParameterValue(ParameterInfo, /*out*/ParentValue);
+			if (bIsGlobal)
+			{
+				ParentValues.Textures.Add(ParameterInfo.Name, {ParentValue, bIsResolved});
+			}
+
+			if (!bIsResolved)
+			{
+				continue;
+			}
+		}
+		else if (!CachedValue->bIsResolved)
+		{
+			continue;
+		}
+
+		Material.SetTextureParameterValueByInfo(ParameterInfo, ParentValue);
+	}
+}
+
+#if WITH_EDITOR
+// Clears cached values once any material is changed in editor, since children of changed material inherit its values as well
+void UPoolFactory_MaterialInstanceDynamic::OnObjectPropertyChanged(UObject* Object, FPropertyChangedEvent& PropertyChangedEvent)
+{
+	if (Object
+		&& Object->IsA<UMaterialInterface>())
+	{
+		ParentValuesInternal.Empty();
+	}
+}
+#endif // WITH_EDITOR
@@ -0,0 +1,219 @@
+﻿// Copyright (c) Yevhenii Selivanov
+
+#include "Factories/PoolFactory_Pawn.h"
+//---
+#include "AIController.h"
+#include "BrainComponent.h"
+#include "GameFramework/Pawn.h"
+#include "GameFramework/PawnMovementComponent.h"
+#include "Perception/AIPerceptionComponent.h"
+#include "Perception/AIPerceptionStimuliSourceComponent.h"
+#include "Perception/AISenseConfig.h"
+//---
+#include UE_INLINE_GENERATED_CPP_BY_NAME(PoolFactory_Pawn)
+
+// Is overridden to handle Pawn-inherited classes
+const UClass* UPoolFactory_Pawn::GetObjectClass_Implementation() const
+{
+	return APawn::StaticClass();
+}
+
+/*********************************************************************************************
+ * Creation
+ ********************************************************************************************* */
+
+// Is overridden to stop the logic of pre-warmed pawn, since its controller starts it on spawning
+void UPoolFactory_Pawn::OnPreRegistered(const FSpawnRequest& Request, const FPoolObjectData& ObjectData)
+{
+	Super::OnPreRegistered(Request, ObjectData);
+
+	// Pawn was registered before its spawning was finished, so its controller exists only now
+	APawn& Pawn = ObjectData.GetChecked<APawn>();
+	if (!ObjectData.bIsActive)
+	{
+		SetControllerStateInPool(Pawn, false);
+	}
+}
+
+/*********************************************************************************************
+ * Destruction
+ ********************************************************************************************* */
+
+// Is overridden to destroy the controller together with its pawn
+void UPoolFactory_Pawn::Destroy_Implementation(UObject* Object)
+{
+	APawn* Pawn = CastChecked<APawn>(Object);
+
+	// State is removed here for pawns destroyed by the pool, others are removed once they are found stale
+	FPoolPawnAIState AIState;
+	PooledAIStatesInternal.RemoveAndCopyValue(Pawn, AIState);
+	AController* Controller = Pawn->GetController() ? Pawn->GetController() : AIState.Controller.Get();
+
+	Super::Destroy_Implementation(Object);
+
+	// Player controllers belong to players, so only AI ones are destroyed
+	if (IsValid(Controller)
+		&& !Controller->IsPlayerController()
+		&& !Controller->IsActorBeingDestroyed())
+	{
+		Controller->Destroy();
+	}
+}
+
+/*********************************************************************************************
+ * Pool
+ ********************************************************************************************* */
+
+// Is overridden to pause or resume the controller of the pawn together with the actor
+void UPoolFactory_Pawn::SetActorStateInPool(AActor& Actor, bool bActivate)
+{
+	Super::SetActorStateInPool(Actor, bActivate);
+
+	if (APawn* Pawn = Cast<APawn>(&Actor))
+	{
+		SetControllerStateInPool(*Pawn, bActivate);
+	}
+}
+
+// Stops or restarts the brain, movement and perception of given pawn and its controller
+void UPoolFactory_Pawn::SetControllerStateInPool(APawn& Pawn, bool bActivate)
+{
+	if (!bPoolControllers
+		|| !Pawn.IsActorInitialized()
+		|| !Pawn.HasAuthority()) // Controllers of AI exist only on server
+	{
+		return;
+	}
+
+	if (bActivate)
+	{
+		// Possess again only if the pawn lost its controller while it was active, otherwise it's still possessed
+		// Is looked up by valid pawn, so states of destroyed pawns are never found
+		const FPoolPawnAIState* PooledState = PooledAIStatesInternal.Find(&Pawn);
+		if (PooledState
+			&& !Pawn.GetController())
+		{
+			if (AController* Controller = PooledState->Controller.Get();
+				IsValid(Controller) && !Controller->GetPawn())
+			{
+				Controller->Possess(&Pawn);
+			}
+			else if (PooledState->bHadAIController // Player pawns are never given AI controller
+				&& (Pawn.AutoPossessAI == EAutoPossessAI::Spawned || Pawn.AutoPossessAI == EAutoPossessAI::PlacedInWorldOrSpawned))
+			{
+				// The controller was destroyed by gameplay code, so this is the only case it's spawned again
+				Pawn.SpawnDefaultController();
+			}
+		}
+	}
+	else if (UPawnMovementComponent* MovementComponent = Pawn.GetMovementComponent())
+	{
+		MovementComponent->StopMovementImmediately();
+	}
+
+	// State is recorded on return, so exactly the same is restored on take
+	// Is found after possessing, since gameplay code reacting to it could change recorded states of other pawns
+	FPoolPawnAIState* FoundState = PooledAIStatesInternal.Find(&Pawn);
+	if (!FoundState)
+	{
+		// Pawns destroyed by gameplay code never reach Destroy() of this factory, so their states are removed once new pawn is recorded
+		for (auto It = PooledAIStatesInternal.CreateIterator(); It; ++It)
+		{
+			if (!It.Key().IsValid())
+			{
+				It.RemoveCurrent();
+			}
+		}
+
+		FoundState = &PooledAIStatesInternal.Add(&Pawn);
+	}
+	FPoolPawnAIState& AIState = *FoundState;
+
+	// Stimuli sources are unregistered, so free pawns are not perceived by other AI, only registered ones are registered again
+	if (UAIPerceptionStimuliSourceComponent* StimuliSource = Pawn.FindComponentByClass<UAIPerceptionStimuliSourceComponent>())
+	{
+		if (!bActivate)
+		{
+			AIState.bIsStimuliSourceRegistered = IsAutoRegisteredAsSource(*StimuliSource);
+			StimuliSource->UnregisterFromPerceptionSystem();
+		}
+		else if (AIState.bIsStimuliSourceRegistered)
+		{
+			StimuliSource->RegisterWithPerceptionSystem();
+		}
+	}
+
+	AAIController* AIController = Cast<AAIController>(Pawn.GetController());
+	if (!AIController)
+	{
+		return;
+	}
+
+	// Is recorded while the pawn is possessed, since gameplay code often unpossesses it before returning, e.g: on death
+	AIState.Controller = AIController;
+	AIState.bHadAIController = true;
+
+	if (!bActivate)
+	{
+		AIController->StopMovement();
+		AIController->ClearFocus(EAIFocusPriority::Gameplay);
+	}
+
+	AIController->SetActorTickEnabled(bActivate);
+
+	// Free pawn does not sense anything and forgets everything it sensed before, so it starts from scratch on take
+	if (UAIPerceptionComponent* PerceptionComponent = AIController->GetPerceptionComponent())
+	{
+		if (!bActivate)
+		{
+			PerceptionComponent->ForgetAll();
+			AIState.EnabledSenses.Reset();
+		}
+
+		for (UAIPerceptionComponent::TAISenseConfigConstIterator It = PerceptionComponent->GetSensesConfigIterator(); It; ++It)
+		{
+			const UAISenseConfig* SenseConfig = *It;
+			const TSubclassOf<UAISense> SenseClass = SenseConfig ? SenseConfig->GetSenseImplementation() : nullptr;
+			if (!SenseClass)
+			{
+				continue;
+			}
+
+			if (!bActivate)
+			{
+				// Senses disabled by gameplay code stay disabled on take
+				if (PerceptionComponent->IsSenseEnabled(SenseClass))
+				{
+					AIState.EnabledSenses.Emplace(SenseClass);
+					PerceptionComponent->SetSenseEnabled(SenseClass, false);
+				}
+			}
+			else if (AIState.EnabledSenses.Contains(SenseClass))
+			{
+				PerceptionComponent->SetSenseEnabled(SenseClass, true);
+			}
+		}
+	}
+
+	// Brain is stopped instead of being paused, so free pawns keep no execution state and start their logic from the root on take
+	if (UBrainComponent* BrainComponent = AIController->GetBrainComponent())
+	{
+		if (bActivate)
+		{
+			BrainComponent->RestartLogic();
+		}
+		else
+		{
+			BrainComponent->StopLogic(TEXT("Returned to pool"));
+		}
+	}
+}
+
+// Returns true if given stimuli source registers itself with the perception system
+bool UPoolFactory_Pawn::IsAutoRegisteredAsSource(const UAIPerceptionStimuliSourceComponent& StimuliSource)
+{
+	// Is protected in the engine, so it's read by reflection
+	static const FBoolProperty* AutoRegisterProperty = FindFProperty<FBoolProperty>(UAIPerceptionStimuliSourceComponent::StaticClass(), TEXT("bAutoRegisterAsSource"));
+	return AutoRegisterProperty
+		&& AutoRegisterProperty->GetPropertyValue_InContainer(&StimuliSource);
+}
@@ -2,6 +2,7 @@
 
 #include "Factories/PoolFactory_UObject.h"
 //---
+#include "PoolManagerSubsystem.h"
 #include "PoolObjectCallback.h"
 #include "Data/PoolManagerSettings.h"
 //---
@@ -10,6 +11,12 @@
 //---
 #include UE_INLINE_GENERATED_CPP_BY_NAME(PoolFactory_UObject)
 
+// Returns the Pool Manager that owns this factory
+UPoolManagerSubsystem* UPoolFactory_UObject::GetPoolManager() const
+{
+	return Cast<UPoolManagerSubsystem>(GetOuter());
+}
+
 /*********************************************************************************************
  * Creation
  ********************************************************************************************* */
@@ -22,6 +29,18 @@ void UPoolFactory_UObject::RequestSpawn_Implementation(const FSpawnRequest& Requ
 		return;
 	}
 
+	if (!CanSpawn(Request))
+	{
+		// Is completed with no object, so the caller is not waiting for it forever
+		if (Request.Callbacks.OnPostSpawned != nullptr)
+		{
+			FPoolObjectData RejectedData;
+			RejectedData.Handle = Request.Handle;
+			Request.Callbacks.OnPostSpawned(RejectedData);
+		}
+		return;
+	}
+
 	// Lambda to find the correct insertion index based on priority
 	auto FindInsertionIndex = [&](ESpawnRequestPriority Priority)
 	{
@@ -37,13 +56,17 @@ void UPoolFactory_UObject::RequestSpawn_Implementation(const FSpawnRequest& Requ
 		return InsertIdx;
 	};
 
+	FSpawnRequest QueuedRequest = Request;
+	QueuedRequest.RequestedFrame = GFrameCounter;
+	QueuedRequest.RequestedTime = FPlatformTime::Seconds();
+
 	// Insert request based on priority
 	switch (Request.Priority)
 	{
 	case ESpawnRequestPriority::Critical:
 		{
 			// Immediate processing for Critical priority requests
-			ProcessRequestNow(Request);
+			ProcessRequestNow(QueuedRequest);
 			// Exit since we don't add Critical requests to the queue
 			return;
 		}
@@ -53,13 +76,13 @@ void UPoolFactory_UObject::RequestSpawn_Implementation(const FSpawnRequest& Requ
 		{
 			// Use lambda to find the correct insertion index based on the priority
 			const int32 InsertIdx = FindInsertionIndex(Request.Priority);
-			SpawnQueueInternal.Insert(Request, InsertIdx);
+			SpawnQueueInternal.Insert(MoveTemp(QueuedRequest), InsertIdx);
 		}
 		break;
 
 	case ESpawnRequestPriority::Normal:
 		// Normal, add to the end of the queue
-		SpawnQueueInternal.Emplace(Request);
+		SpawnQueueInternal.Emplace(MoveTemp(QueuedRequest));
 		break;
 
 	default:
@@ -74,7 +97,7 @@ void UPoolFactory_UObject::RequestSpawn_Implementation(const FSpawnRequest& Requ
 		const UWorld* World = GetWorld();
 		checkf(World, TEXT("ERROR: [%i] %hs:\n'World' is null!"), __LINE__, __FUNCTION__);
 
-		World->GetTimerManager().SetTimerForNextTick(this, &ThisClass::OnNextTickProcessSpawn);
+		SpawnTimerInternal = World->GetTimerManager().SetTimerForNextTick(this, &ThisClass::OnNextTickProcessSpawn);
 	}
 }
 
@@ -96,15 +119,26 @@ bool UPoolFactory_UObject::DequeueSpawnRequest(FSpawnRequest& OutRequest)
 // Calls SpawnNow with the given request and process the callbacks
 void UPoolFactory_UObject::ProcessRequestNow(const FSpawnRequest& Request)
 {
+	const double SpawnStartTime = FPlatformTime::Seconds();
 	UObject* CreatedObject = SpawnNow(Request);
 	checkf(CreatedObject, TEXT("ERROR: [%i] %hs:\n'CreatedObject' failed to spawn!"), __LINE__, __FUNCTION__);
 
 	FPoolObjectData ObjectData;
-	ObjectData.bIsActive = true;
+	ObjectData.bIsActive = !Request.bIsPrewarm; // Pre-warmed object is registered as free
 	ObjectData.PoolObject = CreatedObject;
 	ObjectData.Handle = Request.Handle;
+	ObjectData.TakeCallsite = Request.TakeCallsite;
 
 	OnPreRegistered(Request, ObjectData);
+
+	// Registration is measured as well since it activates the object
+	const double SpawnSeconds = FPlatformTime::Seconds() - SpawnStartTime;
+	AddSpawnCostSample(Request.GetClass(), SpawnSeconds);
+	if (UPoolManagerSubsystem* PoolManager = GetPoolManager())
+	{
+		PoolManager->RecordSpawnLatency(Request, SpawnSeconds);
+	}
+
 	OnPostSpawned(Request, ObjectData);
 }
 
@@ -128,6 +162,60 @@ bool UPoolFactory_UObject::DequeueSpawnRequestByHandle(const FPoolObjectHandle&
 	return OutRequest.IsValid();
 }
 
+// Returns number of queued spawn requests of specified class
+int32 UPoolFactory_UObject::GetSpawnRequestsNum(const UClass* ObjectClass) const
+{
+	int32 RequestsNum = 0;
+	for (const FSpawnRequest& RequestIt : SpawnQueueInternal)
+	{
+		if (RequestIt.GetClass() == ObjectClass)
+		{
+			++RequestsNum;
+		}
+	}
+	return RequestsNum;
+}
+
+// Removes queued pre-warming requests of specified class that are not spawned yet
+int32 UPoolFactory_UObject::CancelPrewarmRequests(const UClass* ObjectClass, int32 MaxNum)
+{
+	int32 CancelledNum = 0;
+
+	// Iterate from the end, so the latest requests are cancelled first
+	for (int32 Index = SpawnQueueInternal.Num() - 1; Index >= 0 && CancelledNum < MaxNum; --Index)
+	{
+		const FSpawnRequest& RequestIt = SpawnQueueInternal[Index];
+		if (RequestIt.bIsPrewarm
+			&& RequestIt.GetClass() == ObjectClass)
+		{
+			SpawnQueueInternal.RemoveAt(Index);
+			++CancelledNum;
+		}
+	}
+
+	return CancelledNum;
+}
+
+// Spawns all queued requests right now regardless of the spawn budget
+void UPoolFactory_UObject::FlushSpawnQueue()
+{
+	// New requests could be added by callbacks, so process until the queue is empty
+	while (!SpawnQueueInternal.IsEmpty())
+	{
+		FSpawnRequest OutRequest;
+		if (DequeueSpawnRequest(OutRequest))
+		{
+			ProcessRequestNow(OutRequest);
+		}
+	}
+
+	// Nothing is left to process, so the scheduled processing is not needed anymore
+	if (const UWorld* World = GetWorld())
+	{
+		World->GetTimerManager().ClearTimer(SpawnTimerInternal);
+	}
+}
+
 // Method to immediately spawn requested object
 UObject* UPoolFactory_UObject::SpawnNow_Implementation(const FSpawnRequest& Request)
 {
@@ -151,26 +239,42 @@ void UPoolFactory_UObject::OnPostSpawned(const FSpawnRequest& Request, const FPo
 		Request.Callbacks.OnPostSpawned(ObjectData);
 	}
 
-	// Is optional callback if object implements interface
-	if (ObjectData && ObjectData->Implements<UPoolObjectCallback>())
+	// Is optional callback if object implements interface, pre-warmed object is not taken yet
+	if (ObjectData
+		&& !Request.bIsPrewarm
+		&& ObjectData->Implements<UPoolObjectCallback>())
 	{
 		constexpr bool bIsNewSpawned = true;
-		IPoolObjectCallback::Execute_OnTakeFromPool(ObjectData.Get(), bIsNewSpawned, Request.Transform);
+		IPoolObjectCallback::Execute_OnTakeFromPool(ObjectData.Get(), bIsNewSpawned, Request.Transform, Request.Payload);
 	}
 }
 
 // Is called on next frame to process a chunk of the spawn queue
 void UPoolFactory_UObject::OnNextTickProcessSpawn_Implementation()
 {
-	int32 ObjectsPerFrame = UPoolManagerSettings::Get().GetSpawnObjectsPerFrame();
+	int32 ObjectsPerFrame = GetSpawnObjectsPerFrame();
 	if (!ensureMsgf(ObjectsPerFrame >= 1, TEXT("ASSERT: [%i] %hs:\n'ObjectsPerFrame' is less than 1, set the config!"), __LINE__, __FUNCTION__))
 	{
 		ObjectsPerFrame = 1;
 	}
 
+	// Pack spawns into the frame by estimated costs of their classes, but spawn at least one object to keep the queue moving
+	const float BudgetMs = GetSpawnBudgetMs();
+	const double FrameStartTime = FPlatformTime::Seconds();
 	const int32 NumToSpawn = FMath::Min(ObjectsPerFrame, SpawnQueueInternal.Num());
-	for (int32 Index = 0; Index < NumToSpawn; ++Index)
+	for (int32 Index = 0; Index < NumToSpawn && !SpawnQueueInternal.IsEmpty(); ++Index)
 	{
+		if (BudgetMs > 0.f
+			&& Index > 0)
+		{
+			const float UsedMs = static_cast<float>((FPlatformTime::Seconds() - FrameStartTime) * 1000.0);
+			const float NextCostMs = SpawnCostsInternal.FindRef(SpawnQueueInternal[0].GetClass()).SpawnMs;
+			if (UsedMs + NextCostMs > BudgetMs)
+			{
+				break;
+			}
+		}
+
 		FSpawnRequest OutRequest;
 		if (DequeueSpawnRequest(OutRequest))
 		{
@@ -184,7 +288,67 @@ void UPoolFactory_UObject::OnNextTickProcessSpawn_Implementation()
 	{
 		const UWorld* World = GetWorld();
 		checkf(World, TEXT("ERROR: [%i] %hs:\n'World' is null!"), __LINE__, __FUNCTION__);
-		World->GetTimerManager().SetTimerForNextTick(this, &ThisClass::OnNextTickProcessSpawn);
+		SpawnTimerInternal = World->GetTimerManager().SetTimerForNextTick(this, &ThisClass::OnNextTickProcessSpawn);
+	}
+}
+
+// Returns a limit of how many objects to spawn per frame according to the budget mode of the Pool Manager
+int32 UPoolFactory_UObject::GetSpawnObjectsPerFrame() const
+{
+	const UPoolManagerSubsystem* PoolManager = GetPoolManager();
+	return PoolManager ? PoolManager->GetSpawnObjectsPerFrame() : UPoolManagerSettings::Get().GetSpawnObjectsPerFrame();
+}
+
+// Returns milliseconds that spawning can take per frame according to the budget mode of the Pool Manager
+float UPoolFactory_UObject::GetSpawnBudgetMs() const
+{
+	const UPoolManagerSubsystem* PoolManager = GetPoolManager();
+	return PoolManager ? PoolManager->GetSpawnBudgetMs() : UPoolManagerSettings::Get().GetSpawnBudgetMs();
+}
+
+/*********************************************************************************************
+ * Cost
+ ********************************************************************************************* */
+
+// Adds measured time of SpawnNow and OnPreRegistered to the spawn cost of given class
+void UPoolFactory_UObject::AddSpawnCostSample(const UClass* ObjectClass, double Seconds)
+{
+	if (!ObjectClass)
+	{
+		return;
+	}
+
+	FPoolSpawnCost& Cost = SpawnCostsInternal.FindOrAdd(ObjectClass);
+	FPoolSpawnCost::AddSample(Cost.SpawnMs, Cost.SpawnSamplesNum, Seconds);
+
+	// Such object takes whole frame budget alone, so it should be pre-warmed behind the loading screen instead
+	const float BudgetMs = GetSpawnBudgetMs();
+	if (BudgetMs > 0.f
+		&& Cost.SpawnMs > BudgetMs
+		&& !Cost.bIsOverBudgetWarned)
+	{
+		Cost.bIsOverBudgetWarned = true;
+		UE_LOG(LogPoolManager, Warning, TEXT("'%s' costs %.2f ms to spawn that is more than the whole spawn budget of %.2f ms, consider pre-warming it while loading"),
+		       *ObjectClass->GetName(), Cost.SpawnMs, BudgetMs);
+	}
+}
+
+// Adds measured time of taking or returning the object to the cost of given class
+void UPoolFactory_UObject::AddActivationCostSample(const UClass* ObjectClass, EPoolObjectState NewState, double Seconds)
+{
+	if (!ObjectClass)
+	{
+		return;
+	}
+
+	FPoolSpawnCost& Cost = SpawnCostsInternal.FindOrAdd(ObjectClass);
+	if (NewState == EPoolObjectState::Active)
+	{
+		FPoolSpawnCost::AddSample(Cost.TakeMs, Cost.TakeSamplesNum, Seconds);
+	}
+	else
+	{
+		FPoolSpawnCost::AddSample(Cost.ReturnMs, Cost.ReturnSamplesNum, Seconds);
 	}
 }
 
@@ -203,15 +367,30 @@ void UPoolFactory_UObject::Destroy_Implementation(UObject* Object)
  * Pool
  ********************************************************************************************* */
 
+// Returns free object of given pool to take for requested payload or null if there are no such objects
+FPoolObjectData* UPoolFactory_UObject::FindFreeObject(FPoolContainer& Pool, const FInstancedStruct& Payload)
+{
+	return Pool.PoolObjects.FindByPredicate([this, &Payload](const FPoolObjectData& DataIt)
+	{
+		return DataIt.IsFree()
+			&& CanTakeFromPool(DataIt.Get(), Payload);
+	});
+}
+
 // Is called right before taking the object from its pool
-void UPoolFactory_UObject::OnTakeFromPool_Implementation(UObject* Object, const FTransform& Transform)
+void UPoolFactory_UObject::OnTakeFromPool_Implementation(UObject* Object, const FTransform& Transform, const FInstancedStruct& Payload)
 {
 	// Is optional callback if object implements interface
 	if (Object && Object->Implements<UPoolObjectCallback>())
 	{
 		constexpr bool bIsNewSpawned = false;
-		IPoolObjectCallback::Execute_OnTakeFromPool(Object, bIsNewSpawned, Transform);
+		IPoolObjectCallback::Execute_OnTakeFromPool(Object, bIsNewSpawned, Transform, Payload);
 	}
+
+	// Keeps code factories overriding the old signature working until they are updated
+	PRAGMA_DISABLE_DEPRECATION_WARNINGS
+	OnTakeFromPool_Implementation(Object, Transform);
+	PRAGMA_ENABLE_DEPRECATION_WARNINGS
 }
 
 // Is called right before returning the object back to its pool
@@ -224,6 +403,13 @@ void UPoolFactory_UObject::OnReturnToPool_Implementation(UObject* Object)
 	}
 }
 
+// Returns estimated memory in bytes used by given object
+int64 UPoolFactory_UObject::EstimateObjectSize_Implementation(const UObject* Object) const
+{
+	UObject* MutableObject = const_cast<UObject*>(Object);
+	return MutableObject ? static_cast<int64>(MutableObject->GetResourceSizeBytes(EResourceSizeMode::EstimatedTotal)) : 0;
+}
+
 // Is called when activates the object to take it from pool or deactivate when is returned back
 void UPoolFactory_UObject::OnChangedStateInPool_Implementation(EPoolObjectState NewState, UObject* InObject)
 {
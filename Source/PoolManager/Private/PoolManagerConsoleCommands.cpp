@@ -0,0 +1,289 @@
+﻿// Copyright (c) Yevhenii Selivanov
+
+#include "PoolManagerSubsystem.h"
+#include "Factories/PoolFactory_UObject.h"
+//---
+#include "Engine/World.h"
+#include "HAL/IConsoleManager.h"
+#include "Misc/OutputDevice.h"
+#include "UObject/UObjectGlobals.h"
+
+/*********************************************************************************************
+ * Console Commands
+ * Are available in all builds that have the console (including Test builds) to inspect and control pools on devices.
+ ********************************************************************************************* */
+
+namespace PoolManagerConsoleCommands
+{
+	// Returns the Pool Manager of given world, or prints the error
+	UPoolManagerSubsystem* GetPoolManager(UWorld* World, FOutputDevice& Ar)
+	{
+		UPoolManagerSubsystem* PoolManager = World ? World->GetSubsystem<UPoolManagerSubsystem>() : nullptr;
+		if (!PoolManager)
+		{
+			Ar.Logf(TEXT("Pool Manager is not found for the current world"));
+		}
+		return PoolManager;
+	}
+
+	// Returns the class by its name or path, registered pools are checked first, so short names of blueprint classes are found as well
+	const UClass* FindClass(const UPoolManagerSubsystem& PoolManager, const FString& ClassName, FOutputDevice& Ar)
+	{
+		for (const FPoolContainer& PoolIt : PoolManager.GetAllPools())
+		{
+			if (PoolIt.ObjectClass
+				&& (PoolIt.ObjectClass->GetName().Equals(ClassName, ESearchCase::IgnoreCase)
+					|| PoolIt.ObjectClass->GetPathName().Equals(ClassName, ESearchCase::IgnoreCase)))
+			{
+				return PoolIt.ObjectClass;
+			}
+		}
+
+		const UClass* FoundClass = ClassName.Contains(TEXT("/"))
+			                           ? LoadObject<UClass>(nullptr, *ClassName)
+			                           : UClass::TryFindTypeSlow<UClass>(ClassName);
+		if (!FoundClass)
+		{
+			Ar.Logf(TEXT("Class '%s' is not found, use its name or full path"), *ClassName);
+		}
+		return FoundClass;
+	}
+
+	// Prints all pools with their class, free/active/total counts, queue depth, memory estimate and hit rate
+	void Dump(const TArray<FString>& Args, UWorld* World, FOutputDevice& Ar)
+	{
+		const UPoolManagerSubsystem* PoolManager = GetPoolManager(World, Ar);
+		if (!PoolManager)
+		{
+			return;
+		}
+
+		const TArray<FPoolContainer>& AllPools = PoolManager->GetAllPools();
+		Ar.Logf(TEXT("Pool Manager of '%s': %i pools, budget mode: %s, spawn objects per frame: %i"),
+		        *GetNameSafe(World), AllPools.Num(),
+		        *StaticEnum<EPoolSpawnBudgetMode>()->GetNameStringByValue(static_cast<int64>(PoolManager->GetSpawnBudgetMode())),
+		        PoolManager->GetSpawnObjectsPerFrame());
+		Ar.Logf(TEXT("%-48s %8s %8s %8s %8s %12s %8s"), TEXT("Class"), TEXT("Free"), TEXT("Active"), TEXT("Total"), TEXT("Queued"), TEXT("Memory KB"), TEXT("Hit %"));
+
+		int64 TotalMemoryBytes = 0;
+		for (const FPoolContainer& PoolIt : AllPools)
+		{
+			const UClass* ObjectClass = PoolIt.ObjectClass;
+			if (!ObjectClass)
+			{
+				continue;
+			}
+
+			const int32 FreeNum = PoolManager->GetFreeObjectsNum(ObjectClass);
+			const int32 TotalNum = PoolManager->GetRegisteredObjectsNum(ObjectClass);
+			const int32 QueuedNum = PoolIt.Factory ? PoolIt.Factory->GetSpawnRequestsNum(ObjectClass) : 0;
+			const int64 MemoryBytes = PoolManager->GetPoolMemorySize(ObjectClass);
+			TotalMemoryBytes += MemoryBytes;
+
+			Ar.Logf(TEXT("%-48s %8i %8i %8i %8i %12.1f %7.1f%%"),
+			        *ObjectClass->GetName(), FreeNum, TotalNum - FreeNum, TotalNum, QueuedNum,
+			        MemoryBytes / 1024.f, PoolIt.GetHitRate() * 100.f);
+		}
+
+		Ar.Logf(TEXT("Total estimated memory: %.2f MB"), TotalMemoryBytes / (1024.f * 1024.f));
+	}
+
+	// Creates free objects in advance until the pool contains specified amount
+	void Prewarm(const TArray<FString>& Args, UWorld* World, FOutputDevice& Ar)
+	{
+		UPoolManagerSubsystem* PoolManager = GetPoolManager(World, Ar);
+		if (!PoolManager)
+		{
+			return;
+		}
+
+		if (Args.Num() < 2)
+		{
+			Ar.Logf(TEXT("Usage: PoolManager.Prewarm <Class> <Amount>"));
+			return;
+		}
+
+		if (const UClass* ObjectClass = FindClass(*PoolManager, Args[0], Ar))
+		{
+			const int32 NewNum = PoolManager->PrewarmPool(ObjectClass, FCString::Atoi(*Args[1]));
+			Ar.Logf(TEXT("Requested %i new objects of '%s'"), NewNum, *ObjectClass->GetName());
+		}
+	}
+
+	// Pre-warms or shrinks the pool to specified amount
+	void Resize(const TArray<FString>& Args, UWorld* World, FOutputDevice& Ar)
+	{
+		UPoolManagerSubsystem* PoolManager = GetPoolManager(World, Ar);
+		if (!PoolManager)
+		{
+			return;
+		}
+
+		if (Args.Num() < 2)
+		{
+			Ar.Logf(TEXT("Usage: PoolManager.Resize <Class> <Amount>"));
+			return;
+		}
+
+		const UClass* ObjectClass = FindClass(*PoolManager, Args[0], Ar);
+		if (!ObjectClass)
+		{
+			return;
+		}
+
+		const int32 Amount = FMath::Max(FCString::Atoi(*Args[1]), 0);
+		PoolManager->ResizePool(ObjectClass, Amount);
+		Ar.Logf(TEXT("Resizing '%s' to %i objects"), *ObjectClass->GetName(), Amount);
+	}
+
+	// Destroys free objects of given pool or of all pools, but keeps specified amount of them
+	void Trim(const TArray<FString>& Args, UWorld* World, FOutputDevice& Ar)
+	{
+		UPoolManagerSubsystem* PoolManager = GetPoolManager(World, Ar);
+		if (!PoolManager)
+		{
+			return;
+		}
+
+		TArray<const UClass*> ObjectClasses;
+		if (Args.IsValidIndex(0)
+			&& !Args[0].Equals(TEXT("All"), ESearchCase::IgnoreCase))
+		{
+			if (const UClass* ObjectClass = FindClass(*PoolManager, Args[0], Ar))
+			{
+				ObjectClasses.Emplace(ObjectClass);
+			}
+		}
+		else
+		{
+			for (const FPoolContainer& PoolIt : PoolManager->GetAllPools())
+			{
+				ObjectClasses.Emplace(PoolIt.ObjectClass);
+			}
+		}
+
+		const int32 KeepFreeNum = Args.IsValidIndex(1) ? FMath::Max(FCString::Atoi(*Args[1]), 0) : 0;
+		for (const UClass* ClassIt : ObjectClasses)
+		{
+			const int32 DropNum = PoolManager->GetFreeObjectsNum(ClassIt) - KeepFreeNum;
+			if (DropNum > 0)
+			{
+				PoolManager->ShrinkPool(ClassIt, PoolManager->GetRegisteredObjectsNum(ClassIt) - DropNum);
+				Ar.Logf(TEXT("Trimming %i free objects of '%s'"), DropNum, *ClassIt->GetName());
+			}
+		}
+	}
+
+	// Spawns all queued requests right now
+	void FlushQueues(const TArray<FString>& Args, UWorld* World, FOutputDevice& Ar)
+	{
+		if (UPoolManagerSubsystem* PoolManager = GetPoolManager(World, Ar))
+		{
+			PoolManager->FlushSpawnQueues();
+			Ar.Logf(TEXT("All spawn queues are flushed"));
+		}
+	}
+
+	// Sets or toggles the spawn budget mode
+	void BudgetMode(const TArray<FString>& Args, UWorld* World, FOutputDevice& Ar)
+	{
+		UPoolManagerSubsystem* PoolManager = GetPoolManager(World, Ar);
+		if (!PoolManager)
+		{
+			return;
+		}
+
+		const UEnum* ModeEnum = StaticEnum<EPoolSpawnBudgetMode>();
+		EPoolSpawnBudgetMode NewMode = PoolManager->GetSpawnBudgetMode() == EPoolSpawnBudgetMode::Gameplay
+			                               ? EPoolSpawnBudgetMode::Loading
+			                               : EPoolSpawnBudgetMode::Gameplay;
+		if (Args.IsValidIndex(0))
+		{
+			const int64 ModeValue = ModeEnum->GetValueByNameString(Args[0]);
+			if (ModeValue == INDEX_NONE)
+			{
+				Ar.Logf(TEXT("Usage: PoolManager.BudgetMode [Gameplay|Loading]"));
+				return;
+			}
+			NewMode = static_cast<EPoolSpawnBudgetMode>(ModeValue);
+		}
+
+		PoolManager->SetSpawnBudgetMode(NewMode);
+		Ar.Logf(TEXT("Budget mode: %s, spawn objects per frame: %i"), *ModeEnum->GetNameStringByValue(static_cast<int64>(NewMode)), PoolManager->GetSpawnObjectsPerFrame());
+	}
+
+	// Prints hits, misses and latency percentiles of all pools, or resets them
+	void Stats(const TArray<FString>& Args, UWorld* World, FOutputDevice& Ar)
+	{
+		UPoolManagerSubsystem* PoolManager = GetPoolManager(World, Ar);
+		if (!PoolManager)
+		{
+			return;
+		}
+
+		if (Args.IsValidIndex(0)
+			&& Args[0].Equals(TEXT("Reset"), ESearchCase::IgnoreCase))
+		{
+			PoolManager->ResetPoolStats();
+			Ar.Logf(TEXT("Pool stats are reset"));
+			return;
+		}
+
+		PoolManager->LogPoolStats(Ar);
+	}
+
+	// Prints all objects that are taken but not returned longer than their leak threshold, grouped by callsites
+	void LeakReport(const TArray<FString>& Args, UWorld* World, FOutputDevice& Ar)
+	{
+		if (const UPoolManagerSubsystem* PoolManager = GetPoolManager(World, Ar))
+		{
+			PoolManager->LogLeakReport(Ar);
+		}
+	}
+}
+
+static FAutoConsoleCommandWithWorldArgsAndOutputDevice PoolManagerDumpCommand(
+	TEXT("PoolManager.Dump"),
+	TEXT("Prints all pools with their class, free/active/total counts, queue depth, memory estimate and hit rate."),
+	FConsoleCommandWithWorldArgsAndOutputDeviceDelegate::CreateStatic(&PoolManagerConsoleCommands::Dump));
+
+static FAutoConsoleCommandWithWorldArgsAndOutputDevice PoolManagerPrewarmCommand(
+	TEXT("PoolManager.Prewarm"),
+	TEXT("Creates free objects in advance until the pool contains specified amount, is scaled by PoolManager.PrewarmMultiplier.\n")
+	TEXT("Usage: PoolManager.Prewarm <Class> <Amount>"),
+	FConsoleCommandWithWorldArgsAndOutputDeviceDelegate::CreateStatic(&PoolManagerConsoleCommands::Prewarm));
+
+static FAutoConsoleCommandWithWorldArgsAndOutputDevice PoolManagerResizeCommand(
+	TEXT("PoolManager.Resize"),
+	TEXT("Pre-warms or shrinks the pool to specified amount, active objects are never destroyed.\n")
+	TEXT("Usage: PoolManager.Resize <Class> <Amount>"),
+	FConsoleCommandWithWorldArgsAndOutputDeviceDelegate::CreateStatic(&PoolManagerConsoleCommands::Resize));
+
+static FAutoConsoleCommandWithWorldArgsAndOutputDevice PoolManagerTrimCommand(
+	TEXT("PoolManager.Trim"),
+	TEXT("Destroys free objects of given pool or of all pools, but keeps specified amount of them.\n")
+	TEXT("Usage: PoolManager.Trim [Class|All] [KeepFreeNum=0]"),
+	FConsoleCommandWithWorldArgsAndOutputDeviceDelegate::CreateStatic(&PoolManagerConsoleCommands::Trim));
+
+static FAutoConsoleCommandWithWorldArgsAndOutputDevice PoolManagerFlushQueuesCommand(
+	TEXT("PoolManager.FlushQueues"),
+	TEXT("Spawns all queued requests of all factories right now regardless of the spawn budget."),
+	FConsoleCommandWithWorldArgsAndOutputDeviceDelegate::CreateStatic(&PoolManagerConsoleCommands::FlushQueues));
+
+static FAutoConsoleCommandWithWorldArgsAndOutputDevice PoolManagerBudgetModeCommand(
+	TEXT("PoolManager.BudgetMode"),
+	TEXT("Sets the spawn budget mode, toggles it if no mode is specified.\n")
+	TEXT("Usage: PoolManager.BudgetMode [Gameplay|Loading]"),
+	FConsoleCommandWithWorldArgsAndOutputDeviceDelegate::CreateStatic(&PoolManagerConsoleCommands::BudgetMode));
+
+static FAutoConsoleCommandWithWorldArgsAndOutputDevice PoolManagerStatsCommand(
+	TEXT("PoolManager.Stats"),
+	TEXT("Prints hits, misses and latency percentiles of all pools: queue wait in frames and ms, spawn duration and lifetime.\n")
+	TEXT("Usage: PoolManager.Stats [Reset]"),
+	FConsoleCommandWithWorldArgsAndOutputDeviceDelegate::CreateStatic(&PoolManagerConsoleCommands::Stats));
+
+static FAutoConsoleCommandWithWorldArgsAndOutputDevice PoolManagerLeakReportCommand(
+	TEXT("PoolManager.LeakReport"),
+	TEXT("Prints all objects that are taken but not returned longer than their leak threshold, grouped by callsites that took them.\n")
+	TEXT("Threshold is set by PoolManager.LeakThresholdSeconds, callsites are known only in non-shipping builds."),
+	FConsoleCommandWithWorldArgsAndOutputDeviceDelegate::CreateStatic(&PoolManagerConsoleCommands::LeakReport));
@@ -2,17 +2,46 @@
 
 #include "PoolManagerModule.h"
 //---
+#include "Debug/GameplayDebuggerCategory_PoolManager.h"
+//---
+#include "Misc/CoreDelegates.h"
 #include "Modules/ModuleManager.h"
 
+#if WITH_GAMEPLAY_DEBUGGER
+#include "GameplayDebugger.h"
+#endif // WITH_GAMEPLAY_DEBUGGER
+
 void FPoolManagerModule::StartupModule()
 {
 	// This code will execute after your module is loaded into memory; the exact timing is specified in the .uplugin file per-module
+
+#if WITH_GAMEPLAY_DEBUGGER
+	// This module is loaded earlier than the Gameplay Debugger, so register its category once the engine is initialized
+	FCoreDelegates::OnPostEngineInit.AddLambda([]
+	{
+		if (IGameplayDebugger::IsAvailable())
+		{
+			IGameplayDebugger& GameplayDebugger = IGameplayDebugger::Get();
+			GameplayDebugger.RegisterCategory(TEXT("PoolManager"), IGameplayDebugger::FOnGetCategory::CreateStatic(&FGameplayDebuggerCategory_PoolManager::MakeInstance), EGameplayDebuggerCategoryState::EnabledInGameAndSimulate);
+			GameplayDebugger.NotifyCategoriesChanged();
+		}
+	});
+#endif // WITH_GAMEPLAY_DEBUGGER
 }
 
 void FPoolManagerModule::ShutdownModule()
 {
 	// This function may be called during shutdown to clean up your module.  For modules that support dynamic reloading,
 	// we call this function before unloading the module.
+
+#if WITH_GAMEPLAY_DEBUGGER
+	if (IGameplayDebugger::IsAvailable())
+	{
+		IGameplayDebugger& GameplayDebugger = IGameplayDebugger::Get();
+		GameplayDebugger.UnregisterCategory(TEXT("PoolManager"));
+		GameplayDebugger.NotifyCategoriesChanged();
+	}
+#endif // WITH_GAMEPLAY_DEBUGGER
 }
 
 IMPLEMENT_MODULE(FPoolManagerModule, PoolManager)
@@ -0,0 +1,100 @@
+﻿// Copyright (c) Yevhenii Selivanov
+
+#include "PoolManagerPersistentSubsystem.h"
+//---
+#include "PoolManagerSubsystem.h"
+#include "Data/PoolManagerSettings.h"
+//---
+#include "Engine/GameInstance.h"
+#include "Engine/World.h"
+#include "GameFramework/Actor.h"
+//---
+#include UE_INLINE_GENERATED_CPP_BY_NAME(PoolManagerPersistentSubsystem)
+
+// Flags to move objects between outers without affecting packages and transactions
+static constexpr ERenameFlags PoolRenameFlags = REN_DontCreateRedirectors | REN_DoNotDirty | REN_NonTransactional;
+
+// Returns the store of given world's game instance, or null if persistence is disabled
+UPoolManagerPersistentSubsystem* UPoolManagerPersistentSubsystem::GetPersistentStore(const UObject* WorldContext)
+{
+	const UWorld* World = WorldContext ? WorldContext->GetWorld() : nullptr;
+	const UGameInstance* GameInstance = World ? World->GetGameInstance() : nullptr;
+	return GameInstance ? GameInstance->GetSubsystem<UPoolManagerPersistentSubsystem>() : nullptr;
+}
+
+// Is overridden to create the store only if persistence is enabled in the settings
+bool UPoolManagerPersistentSubsystem::ShouldCreateSubsystem(UObject* Outer) const
+{
+	return Super::ShouldCreateSubsystem(Outer)
+		&& UPoolManagerSettings::Get().ShouldPersistPoolsAcrossTravel();
+}
+
+// Keeps given free object until next world adopts it
+void UPoolManagerPersistentSubsystem::StashObject(const FPoolObjectData& InData)
+{
+	UObject* Object = InData.Get();
+	if (!ensureMsgf(IsValid(Object), TEXT("ASSERT: [%i] %hs:\n'Object' is not valid, can't stash it!"), __LINE__, __FUNCTION__))
+	{
+		return;
+	}
+
+	// Objects created inside the world are destroyed together with it, so move them under the game instance
+	// Actors are not renamed since they travel by the seamless travel itself
+	if (!Object->IsA<AActor>()
+		&& Object->GetTypedOuter<UWorld>() != nullptr)
+	{
+		Object->Rename(nullptr, this, PoolRenameFlags);
+	}
+
+	FPoolObjectData& StashedData = StashedObjectsInternal.Emplace_GetRef(InData);
+	StashedData.bIsActive = false;
+}
+
+// Registers all stashed objects that are ready to be adopted in the pools of given Pool Manager
+void UPoolManagerPersistentSubsystem::AdoptObjects(UPoolManagerSubsystem& PoolManager)
+{
+	const UWorld* World = PoolManager.GetWorld();
+	for (int32 Index = StashedObjectsInternal.Num() - 1; Index >= 0; --Index)
+	{
+		const FPoolObjectData DataIt = StashedObjectsInternal[Index];
+		UObject* ObjectIt = DataIt.Get();
+		if (!IsValid(ObjectIt))
+		{
+			StashedObjectsInternal.RemoveAtSwap(Index);
+			continue;
+		}
+
+		const AActor* Actor = Cast<AActor>(ObjectIt);
+		if (Actor && Actor->GetWorld() != World)
+		{
+			// Actor is still traveling, wait until it appears in given world
+			continue;
+		}
+
+		if (ObjectIt->GetOuter() == this)
+		{
+			// Move back into the world, so the object is handled the same way as spawned by its factory
+			ObjectIt->Rename(nullptr, &PoolManager, PoolRenameFlags);
+		}
+
+		StashedObjectsInternal.RemoveAtSwap(Index);
+		PoolManager.RegisterObjectInPool(DataIt);
+	}
+}
+
+// Is called on deinitialization of the store to destroy all objects that were never adopted
+void UPoolManagerPersistentSubsystem::Deinitialize()
+{
+	for (const FPoolObjectData& DataIt : StashedObjectsInternal)
+	{
+		AActor* Actor = DataIt.Get<AActor>();
+		if (IsValid(Actor))
+		{
+			Actor->Destroy();
+		}
+	}
+
+	StashedObjectsInternal.Empty();
+
+	Super::Deinitialize();
+}
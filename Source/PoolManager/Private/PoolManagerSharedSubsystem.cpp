@@ -0,0 +1,277 @@
+﻿// Copyright (c) Yevhenii Selivanov
+
+#include "PoolManagerSharedSubsystem.h"
+//---
+#include "PoolManagerSubsystem.h"
+#include "Data/PoolManagerSettings.h"
+#include "Factories/PoolFactory_UObject.h"
+//---
+#include "Engine/Engine.h"
+#include "Engine/World.h"
+//---
+#include UE_INLINE_GENERATED_CPP_BY_NAME(PoolManagerSharedSubsystem)
+
+/*********************************************************************************************
+ * Static Getters
+ ********************************************************************************************* */
+
+// Returns the shared Pool Manager, is checked and will crash if can't be obtained
+UPoolManagerSharedSubsystem& UPoolManagerSharedSubsystem::Get()
+{
+	UPoolManagerSharedSubsystem* SharedPoolManager = GEngine ? GEngine->GetEngineSubsystem<UPoolManagerSharedSubsystem>() : nullptr;
+	checkf(SharedPoolManager, TEXT("ERROR: [%i] %hs:\n'SharedPoolManager' is null!"), __LINE__, __FUNCTION__);
+	return *SharedPoolManager;
+}
+
+// Returns true if objects of given class don't depend on the world, so can be pooled in shared pools
+bool UPoolManagerSharedSubsystem::IsWorldIndependentClass(const UClass* ObjectClass)
+{
+	if (!ObjectClass)
+	{
+		return false;
+	}
+
+	// Any class handled by more specific factory than UObject one (actors, widgets etc.) depends on the world
+	TArray<UClass*> AllPoolFactories;
+	UPoolManagerSettings::Get().GetPoolFactories(/*out*/AllPoolFactories);
+	for (const UClass* FactoryClassIt : AllPoolFactories)
+	{
+		const UClass* HandledClass = UPoolManagerSubsystem::GetObjectClassByFactory(const_cast<UClass*>(FactoryClassIt));
+		if (HandledClass
+			&& HandledClass != UObject::StaticClass()
+			&& ObjectClass->IsChildOf(HandledClass))
+		{
+			return false;
+		}
+	}
+
+	return true;
+}
+
+/*********************************************************************************************
+ * Lease
+ ********************************************************************************************* */
+
+// Takes free object from the shared pool, or creates new one if there are no free objects, and leases it to the world of given context
+UObject* UPoolManagerSharedSubsystem::LeaseFromSharedPool(const UClass* ObjectClass, const UObject* WorldContext, const FInstancedStruct& Payload/* = FInstancedStruct()*/)
+{
+	check(IsInGameThread());
+
+	const UWorld* World = GEngine->GetWorldFromContextObject(WorldContext, EGetWorldErrorMode::ReturnNull);
+	if (!ensureMsgf(World, TEXT("ASSERT: [%i] %hs:\n'World' is not found by given context!"), __LINE__, __FUNCTION__)
+		|| !ensureMsgf(IsWorldIndependentClass(ObjectClass), TEXT("ASSERT: [%i] %hs:\n'%s' class depends on the world, use UPoolManagerSubsystem instead!"), __LINE__, __FUNCTION__, *GetNameSafe(ObjectClass)))
+	{
+		return nullptr;
+	}
+
+	FPoolContainer& Pool = FindPoolOrAdd(ObjectClass);
+	FPoolObjectData* FoundData = FactoryInternal->FindFreeObject(Pool, Payload);
+
+	if (FoundData)
+	{
+		Pool.SetObjectActive(*FoundData, true);
+		FactoryInternal->OnTakeFromPool(FoundData->Get(), FTransform::Identity, Payload);
+		FactoryInternal->OnChangedStateInPool(EPoolObjectState::Active, FoundData->Get());
+	}
+	else
+	{
+		// No free objects, create new one synchronously, since shared pool does not belong to any world to defer it to next frames
+		FSpawnRequest Request(ObjectClass);
+		Request.Payload = Payload;
+		if (!FactoryInternal->CanSpawn(Request))
+		{
+			return nullptr;
+		}
+
+		FPoolObjectData NewData;
+		NewData.bIsActive = true;
+		NewData.PoolObject = FactoryInternal->SpawnNow(Request);
+		NewData.Handle = Request.Handle;
+		if (!ensureMsgf(NewData.IsValid(), TEXT("ASSERT: [%i] %hs:\n'%s' failed to spawn!"), __LINE__, __FUNCTION__, *GetNameSafe(ObjectClass)))
+		{
+			return nullptr;
+		}
+
+		FoundData = &Pool.PoolObjects.Emplace_GetRef(MoveTemp(NewData));
+		Pool.SetObjectActive(*FoundData, true);
+		FactoryInternal->OnPreRegistered(Request, *FoundData);
+		FactoryInternal->OnChangedStateInPool(EPoolObjectState::Active, FoundData->Get());
+		FactoryInternal->OnPostSpawned(Request, *FoundData);
+	}
+
+	LeasesInternal.Emplace(FoundData->Handle, World);
+
+	// Track peak of concurrent leases to see how much memory is really needed
+	int32& PeakLeasedNum = PeakLeasedNumInternal.FindOrAdd(ObjectClass);
+	PeakLeasedNum = FMath::Max(PeakLeasedNum, Pool.GetActiveObjectsNum());
+
+	return FoundData->Get();
+}
+
+// Returns leased object back to the shared pool, so any world can lease it again
+bool UPoolManagerSharedSubsystem::ReturnLease(UObject* Object)
+{
+	check(IsInGameThread());
+
+	FPoolContainer* Pool = Object ? FindPool(Object->GetClass()) : nullptr;
+	FPoolObjectData* ObjectData = Pool ? Pool->FindInPool(*Object) : nullptr;
+	if (!ObjectData
+		|| !ObjectData->IsActive())
+	{
+		// Is not leased
+		return false;
+	}
+
+	LeasesInternal.Remove(ObjectData->Handle);
+
+	FactoryInternal->OnReturnToPool(Object);
+	Pool->SetObjectActive(*ObjectData, false);
+	FactoryInternal->OnChangedStateInPool(EPoolObjectState::Inactive, Object);
+
+	return true;
+}
+
+// Returns all objects leased by given world back to the shared pools
+void UPoolManagerSharedSubsystem::ReturnAllLeases(const UWorld* World)
+{
+	check(IsInGameThread());
+
+	const TObjectKey<UWorld> WorldKey(World);
+	TArray<FPoolObjectHandle> WorldLeases;
+	for (const TTuple<FPoolObjectHandle, TObjectKey<UWorld>>& LeaseIt : LeasesInternal)
+	{
+		if (LeaseIt.Value == WorldKey)
+		{
+			WorldLeases.Emplace(LeaseIt.Key);
+		}
+	}
+
+	for (const FPoolObjectHandle& HandleIt : WorldLeases)
+	{
+		FPoolContainer* Pool = FindPool(HandleIt.GetObjectClass());
+		const FPoolObjectData* ObjectData = Pool ? Pool->FindInPool(HandleIt) : nullptr;
+		if (!ObjectData
+			|| !ReturnLease(ObjectData->Get()))
+		{
+			// Object was destroyed outside, just forget the lease
+			LeasesInternal.Remove(HandleIt);
+		}
+	}
+}
+
+// Destroys free objects of given class in the shared pool, but keeps specified amount of them
+void UPoolManagerSharedSubsystem::TrimSharedPool(const UClass* ObjectClass, int32 KeepFreeObjectsNum/* = 0*/)
+{
+	FPoolContainer* Pool = FindPool(ObjectClass);
+	if (!Pool)
+	{
+		return;
+	}
+
+	int32 FreeObjectsNum = GetFreeObjectsNum(ObjectClass);
+	TArray<FPoolObjectData>& PoolObjects = Pool->PoolObjects;
+	for (int32 Index = PoolObjects.Num() - 1; Index >= 0 && FreeObjectsNum > KeepFreeObjectsNum; --Index)
+	{
+		const FPoolObjectData& DataIt = PoolObjects[Index];
+		if (!DataIt.IsFree())
+		{
+			continue;
+		}
+
+		FactoryInternal->Destroy(DataIt.Get());
+		PoolObjects.RemoveAt(Index);
+		--FreeObjectsNum;
+	}
+
+	Pool->RebuildActiveIndices();
+}
+
+/*********************************************************************************************
+ * Getters
+ ********************************************************************************************* */
+
+// Returns number of free objects in the shared pool by specified class
+int32 UPoolManagerSharedSubsystem::GetFreeObjectsNum(const UClass* ObjectClass) const
+{
+	const FPoolContainer* Pool = FindPool(ObjectClass);
+	if (!Pool)
+	{
+		return 0;
+	}
+
+	int32 FreeObjectsNum = 0;
+	for (const FPoolObjectData& DataIt : Pool->PoolObjects)
+	{
+		if (DataIt.IsFree())
+		{
+			++FreeObjectsNum;
+		}
+	}
+	return FreeObjectsNum;
+}
+
+// Returns number of objects leased by given world, or by all worlds if null
+int32 UPoolManagerSharedSubsystem::GetLeasedObjectsNum(const UWorld* World/* = nullptr*/) const
+{
+	if (!World)
+	{
+		return LeasesInternal.Num();
+	}
+
+	const TObjectKey<UWorld> WorldKey(World);
+	int32 LeasedNum = 0;
+	for (const TTuple<FPoolObjectHandle, TObjectKey<UWorld>>& LeaseIt : LeasesInternal)
+	{
+		LeasedNum += LeaseIt.Value == WorldKey ? 1 : 0;
+	}
+	return LeasedNum;
+}
+
+/*********************************************************************************************
+ * Protected methods
+ ********************************************************************************************* */
+
+// Is called on initialization of the shared Pool Manager instance
+void UPoolManagerSharedSubsystem::Initialize(FSubsystemCollectionBase& Collection)
+{
+	Super::Initialize(Collection);
+
+	// Base factory creates objects with this subsystem as the outer, so they never belong to any world
+	FactoryInternal = NewObject<UPoolFactory_UObject>(this);
+
+	FWorldDelegates::OnWorldCleanup.AddUObject(this, &ThisClass::OnWorldCleanup);
+}
+
+// Is called on deinitialization of the shared Pool Manager instance
+void UPoolManagerSharedSubsystem::Deinitialize()
+{
+	FWorldDelegates::OnWorldCleanup.RemoveAll(this);
+
+	LeasesInternal.Empty();
+	PoolsInternal.Empty();
+	FactoryInternal = nullptr;
+
+	Super::Deinitialize();
+}
+
+// Returns the pool by specified class
+FPoolContainer& UPoolManagerSharedSubsystem::FindPoolOrAdd(const UClass* ObjectClass)
+{
+	checkf(ObjectClass, TEXT("ERROR: [%i] %hs:\n'ObjectClass' is null!"), __LINE__, __FUNCTION__);
+
+	if (FPoolContainer* Pool = FindPool(ObjectClass))
+	{
+		return *Pool;
+	}
+
+	FPoolContainer& Pool = PoolsInternal.AddDefaulted_GetRef();
+	Pool.ObjectClass = ObjectClass;
+	Pool.Factory = FactoryInternal;
+	return Pool;
+}
+
+// Is called when any world is cleaned up to return all its leases
+void UPoolManagerSharedSubsystem::OnWorldCleanup(UWorld* World, bool bSessionEnded, bool bCleanupResources)
+{
+	ReturnAllLeases(World);
+}
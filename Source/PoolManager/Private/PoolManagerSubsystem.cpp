@@ -2,11 +2,26 @@
 
 #include "PoolManagerSubsystem.h"
 //---
+#include "PoolManagerPersistentSubsystem.h"
+#include "Components/PoolPredictionComponent.h"
 #include "Data/PoolManagerSettings.h"
 #include "Factories/PoolFactory_UObject.h"
 //---
+#include "TimerManager.h"
+#include "Async/ParallelFor.h"
+#include "UObject/Script.h"
+#include "UObject/Stack.h"
+#include "UObject/UObjectGlobals.h"
 #include "Engine/Engine.h"
+#include "Engine/Level.h"
 #include "Engine/World.h"
+#include "Components/SceneComponent.h"
+#include "GameFramework/Actor.h"
+#include "MoviePlayer.h"
+#include "HAL/PlatformStackWalk.h"
+#include "Misc/OutputDevice.h"
+#include "WorldPartition/DataLayer/DataLayerInstance.h"
+#include "WorldPartition/DataLayer/DataLayerManager.h"
 //---
 #if WITH_EDITOR
 #include "Editor.h"
@@ -14,6 +29,16 @@
 //---
 #include UE_INLINE_GENERATED_CPP_BY_NAME(PoolManagerSubsystem)
 
+#if !UE_BUILD_SHIPPING
+// Remembers the address of the code that called the outermost take function, so leaks can be grouped by callsites
+#define POOL_RECORD_TAKE_CALLSITE() TGuardValue<uint64> TakeCallsiteGuard(TakeCallsiteInternal, TakeCallsiteInternal ? TakeCallsiteInternal : reinterpret_cast<uint64>(PLATFORM_RETURN_ADDRESS()))
+// Is the same for Blueprint entry points, their return address points only to the script VM, so the calling Blueprint function is remembered instead
+#define POOL_RECORD_SCRIPT_TAKE_CALLSITE() TGuardValue<uint64> TakeCallsiteGuard(TakeCallsiteInternal, TakeCallsiteInternal ? TakeCallsiteInternal : RecordScriptCallsite())
+#else
+#define POOL_RECORD_TAKE_CALLSITE()
+#define POOL_RECORD_SCRIPT_TAKE_CALLSITE()
+#endif // !UE_BUILD_SHIPPING
+
 /*********************************************************************************************
  * Static Getters
  ********************************************************************************************* */
@@ -53,9 +78,11 @@ UPoolManagerSubsystem* UPoolManagerSubsystem::GetPoolManagerByClass(TSubclassOf<
  ********************************************************************************************* */
 
 // Async version of TakeFromPool() that returns the object by specified class
-void UPoolManagerSubsystem::BPTakeFromPool(const UClass* ObjectClass, const FTransform& Transform, const FOnTakenFromPool& Completed, ESpawnRequestPriority Priority)
+void UPoolManagerSubsystem::BPTakeFromPool(const UClass* ObjectClass, const FTransform& Transform, const FOnTakenFromPool& Completed, ESpawnRequestPriority Priority, const FInstancedStruct& Payload)
 {
-	const FPoolObjectData* ObjectData = TakeFromPoolOrNull(ObjectClass, Transform);
+	POOL_RECORD_SCRIPT_TAKE_CALLSITE();
+
+	const FPoolObjectData* ObjectData = TakeFromPoolOrNull(ObjectClass, Transform, Payload);
 	if (ObjectData)
 	{
 		// Found in pool
@@ -65,6 +92,7 @@ void UPoolManagerSubsystem::BPTakeFromPool(const UClass* ObjectClass, const FTra
 
 	FSpawnRequest Request(ObjectClass);
 	Request.Transform = Transform;
+	Request.Payload = Payload;
 	Request.Priority = Priority;
 	Request.Callbacks.OnPostSpawned = [Completed](const FPoolObjectData& It)
 	{
@@ -74,29 +102,49 @@ void UPoolManagerSubsystem::BPTakeFromPool(const UClass* ObjectClass, const FTra
 }
 
 // Is code async version of TakeFromPool() that calls callback functions when the object is ready
-FPoolObjectHandle UPoolManagerSubsystem::TakeFromPool(const UClass* ObjectClass, const FTransform& Transform/* = FTransform::Identity*/, const FOnSpawnCallback& Completed/* = nullptr*/, ESpawnRequestPriority Priority/* = ESpawnRequestPriority::Normal*/)
+FPoolObjectHandle UPoolManagerSubsystem::TakeFromPool(const UClass* ObjectClass, const FTransform& Transform/* = FTransform::Identity*/, const FOnSpawnCallback& Completed/* = nullptr*/, ESpawnRequestPriority Priority/* = ESpawnRequestPriority::Normal*/, const FInstancedStruct& Payload/* = FInstancedStruct()*/, UObject* Owner/* = nullptr*/)
 {
-	const FPoolObjectData* ObjectData = TakeFromPoolOrNull(ObjectClass, Transform);
+	POOL_RECORD_TAKE_CALLSITE();
+
+	const FPoolObjectData* ObjectData = TakeFromPoolOrNull(ObjectClass, Transform, Payload);
 	if (ObjectData)
 	{
+		const FPoolObjectHandle Handle = ObjectData->Handle;
+		if (Owner)
+		{
+			AssignOwner(Handle, Owner);
+		}
+
 		if (Completed != nullptr)
 		{
 			Completed(*ObjectData);
 		}
 
-		return ObjectData->Handle;
+		return Handle;
 	}
 
 	FSpawnRequest Request(ObjectClass);
 	Request.Transform = Transform;
+	Request.Payload = Payload;
 	Request.Priority = Priority;
 	Request.Callbacks.OnPostSpawned = Completed;
-	return CreateNewObjectInPool(Request);
+	const FPoolObjectHandle Handle = CreateNewObjectInPool(Request);
+
+	if (Owner
+		&& Handle.IsValid()) // Is empty if the request was rejected
+	{
+		// Is bound by handle, so the object is returned even if it's still in the spawning queue
+		AssignOwner(Handle, Owner);
+	}
+
+	return Handle;
 }
 
 // Is internal function to find object in pool or return null
-const FPoolObjectData* UPoolManagerSubsystem::TakeFromPoolOrNull(const UClass* ObjectClass, const FTransform& Transform/* = FTransform::Identity*/)
+const FPoolObjectData* UPoolManagerSubsystem::TakeFromPoolOrNull(const UClass* ObjectClass, const FTransform& Transform/* = FTransform::Identity*/, const FInstancedStruct& Payload/* = FInstancedStruct()*/)
 {
+	POOL_RECORD_TAKE_CALLSITE();
+
 	if (!ensureMsgf(ObjectClass, TEXT("ASSERT: [%i] %hs:\n'ObjectClass' is not specified!"), __LINE__, __FUNCTION__))
 	{
 		return nullptr;
@@ -110,16 +158,9 @@ const FPoolObjectData* UPoolManagerSubsystem::TakeFromPoolOrNull(const UClass* O
 		return nullptr;
 	}
 
-	// Try to find first object contained in the Pool by its class that is inactive and ready to be taken from pool
-	const FPoolObjectData* FoundData = nullptr;
-	for (const FPoolObjectData& DataIt : Pool->PoolObjects)
-	{
-		if (DataIt.IsFree())
-		{
-			FoundData = &DataIt;
-			break;
-		}
-	}
+	// Factory finds the object that is inactive and ready to be taken for requested payload
+	UPoolFactory_UObject& Factory = Pool->GetFactoryChecked();
+	const FPoolObjectData* FoundData = Factory.FindFreeObject(*Pool, Payload);
 
 	if (!FoundData)
 	{
@@ -128,10 +169,14 @@ const FPoolObjectData* UPoolManagerSubsystem::TakeFromPoolOrNull(const UClass* O
 	}
 
 	UObject& InObject = FoundData->GetChecked();
+	++Pool->HitsNum;
 
-	Pool->GetFactoryChecked().OnTakeFromPool(&InObject, Transform);
+	// Configure the object with all requested data in one pass before it becomes active
+	const double TakeStartTime = FPlatformTime::Seconds();
+	Factory.OnTakeFromPool(&InObject, Transform, Payload);
 
 	SetObjectStateInPool(EPoolObjectState::Active, InObject, *Pool);
+	Factory.AddActivationCostSample(ObjectClass, EPoolObjectState::Active, FPlatformTime::Seconds() - TakeStartTime);
 
 	return FoundData;
 }
@@ -143,6 +188,8 @@ const FPoolObjectData* UPoolManagerSubsystem::TakeFromPoolOrNull(const UClass* O
 // Is the same as BPTakeFromPool() but for multiple objects
 void UPoolManagerSubsystem::BPTakeFromPoolArray(const UClass* ObjectClass, int32 Amount, const FOnTakenFromPoolArray& Completed, ESpawnRequestPriority Priority)
 {
+	POOL_RECORD_SCRIPT_TAKE_CALLSITE();
+
 	if (!ensureMsgf(ObjectClass, TEXT("ASSERT: [%i] %hs:\n'ObjectClass' is not specified!"), __LINE__, __FUNCTION__))
 	{
 		return;
@@ -177,8 +224,10 @@ void UPoolManagerSubsystem::BPTakeFromPoolArray(const UClass* ObjectClass, int32
 }
 
 // Is code-overridable alternative version of BPTakeFromPoolArray() that calls callback functions when all objects of the same class are ready
-void UPoolManagerSubsystem::TakeFromPoolArray(TArray<FPoolObjectHandle>& OutHandles, const UClass* ObjectClass, int32 Amount, const FOnSpawnAllCallback& Completed, ESpawnRequestPriority Priority/* = ESpawnRequestPriority::Normal*/)
+void UPoolManagerSubsystem::TakeFromPoolArray(TArray<FPoolObjectHandle>& OutHandles, const UClass* ObjectClass, int32 Amount, const FOnSpawnAllCallback& Completed, ESpawnRequestPriority Priority/* = ESpawnRequestPriority::Normal*/, UObject* Owner/* = nullptr*/)
 {
+	POOL_RECORD_TAKE_CALLSITE();
+
 	if (!ensureMsgf(ObjectClass, TEXT("ASSERT: [%i] %hs:\n'ObjectClass' is not specified!"), __LINE__, __FUNCTION__)
 		|| !ensureMsgf(Amount > 0, TEXT("ASSERT: [%i] %hs:\n'Amount' is less than 1!"), __LINE__, __FUNCTION__))
 	{
@@ -195,6 +244,14 @@ void UPoolManagerSubsystem::TakeFromPoolArray(TArray<FPoolObjectHandle>& OutHand
 	if (Difference == 0)
 	{
 		// All objects are taken from pool
+		if (Owner)
+		{
+			for (const FPoolObjectHandle& HandleIt : OutHandles)
+			{
+				AssignOwner(HandleIt, Owner);
+			}
+		}
+
 		if (Completed)
 		{
 			Completed(FreeObjectsData);
@@ -205,11 +262,21 @@ void UPoolManagerSubsystem::TakeFromPoolArray(TArray<FPoolObjectHandle>& OutHand
 	// --- Create the rest of objects
 	FSpawnRequest::FilterRequests(/*out*/InRequests, FreeObjectsData, Difference);
 	CreateNewObjectsArrayInPool(InRequests, OutHandles, Completed);
+
+	if (Owner)
+	{
+		for (const FPoolObjectHandle& HandleIt : OutHandles)
+		{
+			AssignOwner(HandleIt, Owner);
+		}
+	}
 }
 
 // Is alternative version of TakeFromPool() that can process multiple requests of different classes and different transforms at once
 void UPoolManagerSubsystem::TakeFromPoolArray(TArray<FPoolObjectHandle>& OutHandles, TArray<FSpawnRequest>& InRequests, const FOnSpawnAllCallback& Completed)
 {
+	POOL_RECORD_TAKE_CALLSITE();
+
 	if (!ensureMsgf(!InRequests.IsEmpty(), TEXT("ASSERT: [%i] %hs:\n'InOutRequests' is empty!"), __LINE__, __FUNCTION__))
 	{
 		return;
@@ -246,7 +313,7 @@ void UPoolManagerSubsystem::TakeFromPoolArrayOrNull(TArray<FPoolObjectData>& Out
 
 	for (FSpawnRequest& ItRef : InRequests)
 	{
-		if (const FPoolObjectData* ObjectData = TakeFromPoolOrNull(ItRef.GetClass(), ItRef.Transform))
+		if (const FPoolObjectData* ObjectData = TakeFromPoolOrNull(ItRef.GetClass(), ItRef.Transform, ItRef.Payload))
 		{
 			ItRef.Handle = ObjectData->Handle;
 			OutObjects.Emplace(*ObjectData);
@@ -267,9 +334,12 @@ bool UPoolManagerSubsystem::ReturnToPool_Implementation(UObject* Object)
 	}
 
 	FPoolContainer& Pool = FindPoolOrAdd(Object->GetClass());
-	Pool.GetFactoryChecked().OnReturnToPool(Object);
+	UPoolFactory_UObject& Factory = Pool.GetFactoryChecked();
+	const double ReturnStartTime = FPlatformTime::Seconds();
+	Factory.OnReturnToPool(Object);
 
 	SetObjectStateInPool(EPoolObjectState::Inactive, *Object, Pool);
+	Factory.AddActivationCostSample(Object->GetClass(), EPoolObjectState::Inactive, FPlatformTime::Seconds() - ReturnStartTime);
 
 	return true;
 }
@@ -293,6 +363,7 @@ bool UPoolManagerSubsystem::ReturnToPool(const FPoolObjectHandle& Handle)
 	// cancel spawn request if object returns to pool faster than it is spawned
 	FSpawnRequest OutRequest;
 	const bool bSucceed = Pool.GetFactoryChecked().DequeueSpawnRequestByHandle(Handle, OutRequest);
+	ReleaseOwner(Handle);
 	return ensureMsgf(bSucceed, TEXT("ASSERT: [%i] %hs:\nGiven Handle is not known by Pool Manager and is not even in spawning queue!"), __LINE__, __FUNCTION__);
 }
 
@@ -322,6 +393,377 @@ bool UPoolManagerSubsystem::ReturnToPoolArray(const TArray<FPoolObjectHandle>& H
 	return bSucceed;
 }
 
+/*********************************************************************************************
+ * Active Objects
+ ********************************************************************************************* */
+
+// Calls given visitor for each active object of the pool by specified class
+void UPoolManagerSubsystem::ForEachActive(const UClass* ObjectClass, TFunctionRef<void(const FPoolObjectData& ObjectData)> Visitor) const
+{
+	const FPoolContainer* Pool = ObjectClass ? FindPool(ObjectClass) : nullptr;
+	if (!Pool)
+	{
+		return;
+	}
+
+	for (const int32 IndexIt : Pool->ActiveIndices)
+	{
+		Visitor(Pool->PoolObjects[IndexIt]);
+	}
+}
+
+// Is the same as ForEachActive() but calls the visitor on worker threads in parallel
+void UPoolManagerSubsystem::ParallelForEachActive(const UClass* ObjectClass, TFunctionRef<void(const FPoolObjectData& ObjectData)> Visitor) const
+{
+	const FPoolContainer* Pool = ObjectClass ? FindPool(ObjectClass) : nullptr;
+	if (!Pool)
+	{
+		return;
+	}
+
+	ParallelFor(Pool->ActiveIndices.Num(), [Pool, &Visitor](int32 Index)
+	{
+		Visitor(Pool->PoolObjects[Pool->ActiveIndices[Index]]);
+	});
+}
+
+// Returns all active objects of given class back to the pool in one batch
+int32 UPoolManagerSubsystem::ReturnAllActive(const UClass* ObjectClass)
+{
+	FPoolContainer* Pool = ObjectClass ? FindPool(ObjectClass) : nullptr;
+	const int32 ReturnedNum = Pool ? ReturnActiveInPool(*Pool, [](const UObject* PoolObject) { return true; }) : 0;
+	if (ReturnedNum > 0)
+	{
+		// Pool got new free objects, so it could exceed the budgets
+		RequestEnforcePoolBudgets();
+	}
+
+	return ReturnedNum;
+}
+
+// Returns active objects of all pools that match given predicate back to their pools in one batch
+int32 UPoolManagerSubsystem::ReturnAllActiveByPredicate(const TFunctionRef<bool(const UObject* PoolObject)> Predicate)
+{
+	int32 ReturnedNum = 0;
+
+	// Pools are accessed by index, since callbacks of returned objects could add new pools
+	for (int32 PoolIndex = 0; PoolIndex < PoolsInternal.Num(); ++PoolIndex)
+	{
+		ReturnedNum += ReturnActiveInPool(PoolsInternal[PoolIndex], Predicate);
+	}
+
+	if (ReturnedNum > 0)
+	{
+		// Pools got new free objects, so they could exceed the budgets
+		RequestEnforcePoolBudgets();
+	}
+
+	return ReturnedNum;
+}
+
+// Returns all active objects of given class
+void UPoolManagerSubsystem::GetActiveObjects(const UClass* ObjectClass, TArray<UObject*>& OutObjects) const
+{
+	if (!OutObjects.IsEmpty())
+	{
+		OutObjects.Empty();
+	}
+
+	OutObjects.Reserve(GetActiveObjectsNum(ObjectClass));
+	ForEachActive(ObjectClass, [&OutObjects](const FPoolObjectData& ObjectData)
+	{
+		if (UObject* ObjectIt = ObjectData.Get())
+		{
+			OutObjects.Emplace(ObjectIt);
+		}
+	});
+}
+
+// Returns number of active objects in pool by specified class
+int32 UPoolManagerSubsystem::GetActiveObjectsNum(const UClass* ObjectClass) const
+{
+	const FPoolContainer* Pool = ObjectClass ? FindPool(ObjectClass) : nullptr;
+	return Pool ? Pool->GetActiveObjectsNum() : 0;
+}
+
+/*********************************************************************************************
+ * Active Objects - Spatial Index
+ ********************************************************************************************* */
+
+// Starts tracking locations of active actors of given class in the spatial hash of its pool
+void UPoolManagerSubsystem::EnableSpatialIndex(const UClass* ObjectClass, float CellSize/* = 500.f*/)
+{
+	if (!ensureMsgf(ObjectClass && ObjectClass->IsChildOf<AActor>(), TEXT("ASSERT: [%i] %hs:\n'ObjectClass' is not an actor class!"), __LINE__, __FUNCTION__)
+		|| !ensureMsgf(CellSize > 0.f, TEXT("ASSERT: [%i] %hs:\n'CellSize' has to be positive!"), __LINE__, __FUNCTION__))
+	{
+		return;
+	}
+
+	FPoolContainer& Pool = FindPoolOrAdd(ObjectClass);
+	Pool.SpatialHash.Reset();
+	Pool.SpatialHash.CellSize = CellSize;
+
+	// Track actors that are already taken
+	TArray<UObject*> ActiveObjects;
+	GetActiveObjects(ObjectClass, /*out*/ActiveObjects);
+	for (UObject* ObjectIt : ActiveObjects)
+	{
+		UpdateSpatialIndex(EPoolObjectState::Active, *CastChecked<AActor>(ObjectIt), Pool);
+	}
+}
+
+// Stops tracking locations of active actors of given class
+void UPoolManagerSubsystem::DisableSpatialIndex(const UClass* ObjectClass)
+{
+	FPoolContainer* Pool = ObjectClass ? FindPool(ObjectClass) : nullptr;
+	if (!Pool
+		|| !Pool->SpatialHash.IsEnabled())
+	{
+		return;
+	}
+
+	TArray<UObject*> ActiveObjects;
+	GetActiveObjects(ObjectClass, /*out*/ActiveObjects);
+	for (UObject* ObjectIt : ActiveObjects)
+	{
+		UpdateSpatialIndex(EPoolObjectState::Inactive, *CastChecked<AActor>(ObjectIt), *Pool);
+	}
+
+	Pool->SpatialHash.Reset();
+	Pool->SpatialHash.CellSize = 0.f;
+}
+
+// Returns true if locations of active actors of given class are tracked
+bool UPoolManagerSubsystem::IsSpatialIndexEnabled(const UClass* ObjectClass) const
+{
+	const FPoolContainer* Pool = ObjectClass ? FindPool(ObjectClass) : nullptr;
+	return Pool && Pool->SpatialHash.IsEnabled();
+}
+
+// Returns active actors of given class within specified radius
+void UPoolManagerSubsystem::FindActiveActorsInRadius(const UClass* ObjectClass, const FVector& Center, float Radius, TArray<AActor*>& OutActors) const
+{
+	const FPoolContainer* Pool = ObjectClass ? FindPool(ObjectClass) : nullptr;
+	if (!ensureMsgf(Pool && Pool->SpatialHash.IsEnabled(), TEXT("ASSERT: [%i] %hs:\nSpatial index is not enabled for '%s' class, call EnableSpatialIndex() first!"), __LINE__, __FUNCTION__, *GetNameSafe(ObjectClass)))
+	{
+		OutActors.Empty();
+		return;
+	}
+
+	Pool->SpatialHash.FindInRadius(/*out*/OutActors, Center, Radius);
+}
+
+// Returns up to specified number of active actors of given class that are nearest to the location
+void UPoolManagerSubsystem::FindNearestActiveActors(const UClass* ObjectClass, const FVector& Location, int32 MaxNum, TArray<AActor*>& OutActors) const
+{
+	const FPoolContainer* Pool = ObjectClass ? FindPool(ObjectClass) : nullptr;
+	if (!ensureMsgf(Pool && Pool->SpatialHash.IsEnabled(), TEXT("ASSERT: [%i] %hs:\nSpatial index is not enabled for '%s' class, call EnableSpatialIndex() first!"), __LINE__, __FUNCTION__, *GetNameSafe(ObjectClass)))
+	{
+		OutActors.Empty();
+		return;
+	}
+
+	Pool->SpatialHash.FindNearest(/*out*/OutActors, Location, MaxNum);
+}
+
+// Returns active actor of given class that is farthest from the location
+AActor* UPoolManagerSubsystem::FindFarthestActiveActor(const UClass* ObjectClass, const FVector& Location) const
+{
+	const FPoolContainer* Pool = ObjectClass ? FindPool(ObjectClass) : nullptr;
+	if (!ensureMsgf(Pool && Pool->SpatialHash.IsEnabled(), TEXT("ASSERT: [%i] %hs:\nSpatial index is not enabled for '%s' class, call EnableSpatialIndex() first!"), __LINE__, __FUNCTION__, *GetNameSafe(ObjectClass)))
+	{
+		return nullptr;
+	}
+
+	return Pool->SpatialHash.FindFarthest(Location);
+}
+
+// Adds taken actor to the spatial hash of its pool or removes returned one
+void UPoolManagerSubsystem::UpdateSpatialIndex(EPoolObjectState NewState, AActor& Actor, FPoolContainer& InPool)
+{
+	USceneComponent* RootComponent = Actor.GetRootComponent();
+
+	if (NewState != EPoolObjectState::Active)
+	{
+		InPool.SpatialHash.Remove(Actor);
+		if (RootComponent)
+		{
+			RootComponent->TransformUpdated.RemoveAll(this);
+		}
+		return;
+	}
+
+	if (!RootComponent)
+	{
+		// Blueprint root is created only once spawning is finished, so track it next frame
+		const bool bIsAlreadyPending = !PendingSpatialActorsInternal.IsEmpty();
+		PendingSpatialActorsInternal.AddUnique(&Actor);
+		const UWorld* World = GetWorld();
+		if (!bIsAlreadyPending
+			&& World)
+		{
+			World->GetTimerManager().SetTimerForNextTick(this, &ThisClass::OnNextTickTrackPendingActors);
+		}
+		return;
+	}
+
+	InPool.SpatialHash.Update(Actor, RootComponent->GetComponentLocation());
+
+	// Movement is tracked by the root, so only actors that really move update the hash
+	if (!RootComponent->TransformUpdated.IsBoundToObject(this))
+	{
+		RootComponent->TransformUpdated.AddUObject(this, &ThisClass::OnTrackedActorMoved);
+	}
+}
+
+// Is called when root component of any tracked actor is moved
+void UPoolManagerSubsystem::OnTrackedActorMoved(USceneComponent* UpdatedComponent, EUpdateTransformFlags UpdateTransformFlags, ETeleportType Teleport)
+{
+	AActor* Actor = UpdatedComponent ? UpdatedComponent->GetOwner() : nullptr;
+	FPoolContainer* Pool = Actor ? FindPool(Actor->GetClass()) : nullptr;
+	if (Pool
+		&& Pool->SpatialHash.IsEnabled())
+	{
+		Pool->SpatialHash.Update(*Actor, UpdatedComponent->GetComponentLocation());
+	}
+}
+
+// Is called on next frame to track actors that had no root component when were taken
+void UPoolManagerSubsystem::OnNextTickTrackPendingActors()
+{
+	TArray<TWeakObjectPtr<AActor>> PendingActors = MoveTemp(PendingSpatialActorsInternal);
+	for (const TWeakObjectPtr<AActor>& ActorIt : PendingActors)
+	{
+		AActor* Actor = ActorIt.Get();
+		FPoolContainer* Pool = Actor ? FindPool(Actor->GetClass()) : nullptr;
+		if (Pool
+			&& Pool->SpatialHash.IsEnabled()
+			&& Actor->GetRootComponent() // Actors with no root at all can't be found by location
+			&& IsActive(Actor))
+		{
+			UpdateSpatialIndex(EPoolObjectState::Active, *Actor, *Pool);
+		}
+	}
+}
+
+/*********************************************************************************************
+ * Prediction
+ ********************************************************************************************* */
+
+// CLIENT: takes local stand-in from the pool that predicts the actor to be taken by the server
+FGuid UPoolManagerSubsystem::TakePredictedFromPool(const UClass* ObjectClass, const FTransform& Transform/* = FTransform::Identity*/, const FOnPredictionReconciled& OnReconciled/* = nullptr*/, ESpawnRequestPriority Priority/* = ESpawnRequestPriority::Critical*/, const FInstancedStruct& Payload/* = FInstancedStruct()*/)
+{
+	POOL_RECORD_TAKE_CALLSITE();
+
+	const FPoolObjectHandle StandInHandle = TakeFromPool(ObjectClass, Transform, nullptr, Priority, Payload);
+	if (!ensureMsgf(StandInHandle.IsValid(), TEXT("ASSERT: [%i] %hs:\nFailed to take the stand-in for '%s' class!"), __LINE__, __FUNCTION__, *GetNameSafe(ObjectClass)))
+	{
+		return FGuid();
+	}
+
+	// Handle of the stand-in is unique, so it is shared with the server as the prediction id
+	const FGuid PredictionId = StandInHandle.GetHash();
+	FTimerManager& TimerManager = GetWorld()->GetTimerManager();
+
+	FPoolPrediction& Prediction = PendingPredictionsInternal.FindOrAdd(PredictionId);
+	TimerManager.ClearTimer(Prediction.TimeoutHandle);
+	Prediction.StandInHandle = StandInHandle;
+	Prediction.OnReconciled = OnReconciled;
+
+	// Don't keep the stand-in forever if the server never confirms it
+	const float PredictionTimeout = UPoolManagerSettings::Get().GetPredictionTimeout();
+	if (PredictionTimeout > 0.f)
+	{
+		const TWeakObjectPtr<ThisClass> WeakThis(this);
+		TimerManager.SetTimer(Prediction.TimeoutHandle, [WeakThis, PredictionId]()
+		{
+			if (UPoolManagerSubsystem* PoolManager = WeakThis.Get())
+			{
+				PoolManager->CancelPrediction(PredictionId);
+			}
+		}, PredictionTimeout, false);
+	}
+
+	return PredictionId;
+}
+
+// SERVER: takes the authoritative actor from the pool that will replace client's stand-in with given prediction id
+FPoolObjectHandle UPoolManagerSubsystem::TakeFromPoolForPrediction(const FGuid& PredictionId, const UClass* ObjectClass, const FTransform& Transform/* = FTransform::Identity*/, const FOnSpawnCallback& Completed/* = nullptr*/, ESpawnRequestPriority Priority/* = ESpawnRequestPriority::High*/, const FInstancedStruct& Payload/* = FInstancedStruct()*/)
+{
+	POOL_RECORD_TAKE_CALLSITE();
+
+	if (!ensureMsgf(PredictionId.IsValid(), TEXT("ASSERT: [%i] %hs:\n'PredictionId' is not valid!"), __LINE__, __FUNCTION__))
+	{
+		return FPoolObjectHandle::EmptyHandle;
+	}
+
+	auto OnTaken = [PredictionId, Completed](const FPoolObjectData& ObjectData)
+	{
+		const AActor* Actor = ObjectData.Get<AActor>();
+		UPoolPredictionComponent* PredictionComponent = Actor ? Actor->FindComponentByClass<UPoolPredictionComponent>() : nullptr;
+		if (ensureMsgf(PredictionComponent, TEXT("ASSERT: [%i] %hs:\n'%s' has no Pool Prediction Component, client can't reconcile it!"), __LINE__, __FUNCTION__, *GetNameSafe(Actor)))
+		{
+			// Is set in the same frame with activation, so it is replicated within the same update
+			PredictionComponent->SetPredictionId(PredictionId);
+		}
+
+		if (Completed != nullptr)
+		{
+			Completed(ObjectData);
+		}
+	};
+
+	return TakeFromPool(ObjectClass, Transform, OnTaken, Priority, Payload);
+}
+
+// CLIENT: links the stand-in with the authoritative actor and returns the stand-in to the pool
+bool UPoolManagerSubsystem::ReconcilePrediction(const FGuid& PredictionId, AActor* AuthoritativeActor)
+{
+	FPoolPrediction Prediction;
+	if (!PendingPredictionsInternal.RemoveAndCopyValue(PredictionId, Prediction))
+	{
+		// Is not predicted by this client, or is already reconciled
+		return false;
+	}
+
+	GetWorld()->GetTimerManager().ClearTimer(Prediction.TimeoutHandle);
+
+	const FPoolObjectData& StandInData = FindPoolObjectByHandle(Prediction.StandInHandle);
+	if (Prediction.OnReconciled != nullptr)
+	{
+		Prediction.OnReconciled(StandInData.Get(), AuthoritativeActor);
+	}
+
+	if (StandInData.IsFree())
+	{
+		// Was already returned by outer code
+		return true;
+	}
+
+	// The authoritative actor takes over, so the stand-in is not needed anymore
+	return ReturnToPool(Prediction.StandInHandle);
+}
+
+// CLIENT: returns the stand-in to the pool without reconciliation
+bool UPoolManagerSubsystem::CancelPrediction(const FGuid& PredictionId)
+{
+	FPoolPrediction Prediction;
+	if (!PendingPredictionsInternal.RemoveAndCopyValue(PredictionId, Prediction))
+	{
+		return false;
+	}
+
+	GetWorld()->GetTimerManager().ClearTimer(Prediction.TimeoutHandle);
+
+	const FPoolObjectData& StandInData = FindPoolObjectByHandle(Prediction.StandInHandle);
+	if (StandInData.IsFree())
+	{
+		return true;
+	}
+
+	return ReturnToPool(Prediction.StandInHandle);
+}
+
 /*********************************************************************************************
  * Advanced
  ********************************************************************************************* */
@@ -350,13 +792,48 @@ bool UPoolManagerSubsystem::RegisterObjectInPool_Implementation(const FPoolObjec
 		Data.Handle = FPoolObjectHandle::NewHandle(ObjectClass);
 	}
 
+	// Index from another pool is reset here, SetObjectStateInPool() assigns the new one by SetObjectActive() if the object is active
+	Data.ActiveIndex = INDEX_NONE;
 	Pool.PoolObjects.Emplace(Data);
 
+	if (Pool.ObjectSizeBytes == 0)
+	{
+		// Is measured once per pool since all objects of the same class have similar size
+		Pool.ObjectSizeBytes = Pool.GetFactoryChecked().EstimateObjectSize(Data.PoolObject);
+	}
+
 	SetObjectStateInPool(Data.GetState(), *Data.PoolObject, Pool);
 
 	return true;
 }
 
+// Is the same as RegisterObjectInPool() but for multiple objects
+int32 UPoolManagerSubsystem::RegisterObjectsArrayInPool(const TArray<FPoolObjectData>& InData)
+{
+	int32 RegisteredNum = 0;
+	const UClass* LastClass = nullptr;
+	for (const FPoolObjectData& DataIt : InData)
+	{
+		const UClass* ObjectClass = DataIt.PoolObject ? DataIt.PoolObject.GetClass() : nullptr;
+		if (!ObjectClass)
+		{
+			continue;
+		}
+
+		// Objects of the same class are usually registered together, so reserve the memory for all of them at once
+		if (LastClass != ObjectClass)
+		{
+			FPoolContainer& Pool = FindPoolOrAdd(ObjectClass);
+			Pool.PoolObjects.Reserve(Pool.PoolObjects.Num() + InData.Num() - RegisteredNum);
+			LastClass = ObjectClass;
+		}
+
+		RegisteredNum += RegisterObjectInPool(DataIt) ? 1 : 0;
+	}
+
+	return RegisteredNum;
+}
+
 // Always creates new object and adds it to the pool by its class
 FPoolObjectHandle UPoolManagerSubsystem::CreateNewObjectInPool_Implementation(const FSpawnRequest& InRequest)
 {
@@ -382,7 +859,31 @@ FPoolObjectHandle UPoolManagerSubsystem::CreateNewObjectInPool_Implementation(co
 		}
 	};
 
-	const FPoolContainer& Pool = FindPoolOrAdd(Request.GetClass());
+	FPoolContainer& Pool = FindPoolOrAdd(Request.GetClass());
+	if (!Pool.GetFactoryChecked().CanSpawn(Request))
+	{
+		// Factory logs why it's rejected, the request is completed with no object, so the caller is not waiting for it forever
+		if (Request.Callbacks.OnPostSpawned != nullptr)
+		{
+			// Handle is kept, so spawning of multiple objects is completed even if its last request is rejected
+			FPoolObjectData RejectedData;
+			RejectedData.Handle = Request.Handle;
+			Request.Callbacks.OnPostSpawned(RejectedData);
+		}
+		return FPoolObjectHandle::EmptyHandle;
+	}
+
+	if (!Request.bIsPrewarm)
+	{
+		// Is taken while pool has no free objects
+		++Pool.MissesNum;
+
+		if (!Request.TakeCallsite)
+		{
+			Request.TakeCallsite = TakeCallsiteInternal;
+		}
+	}
+
 	Pool.GetFactoryChecked().RequestSpawn(Request);
 
 	return Request.Handle;
@@ -505,29 +1006,1062 @@ const UClass* UPoolManagerSubsystem::GetObjectClassByFactory(const TSubclassOf<U
 	return FactoryCDO->GetObjectClass();
 }
 
-// Creates all possible Pool Factories to be used by the Pool Manager when dealing with objects
-void UPoolManagerSubsystem::InitializeAllFactories()
+// Spawns all queued requests of all factories right now regardless of the spawn budget
+void UPoolManagerSubsystem::FlushSpawnQueues()
 {
-	TArray<UClass*> AllPoolFactories;
-	UPoolManagerSettings::Get().GetPoolFactories(/*out*/AllPoolFactories);
+	for (const TTuple<TObjectPtr<const UClass>, TObjectPtr<UPoolFactory_UObject>>& It : AllFactoriesInternal)
+	{
+		if (It.Value)
+		{
+			It.Value->FlushSpawnQueue();
+		}
+	}
+}
+
+// Creates all possible Pool Factories to be used by the Pool Manager when dealing with objects
+void UPoolManagerSubsystem::InitializeAllFactories()
+{
+	TArray<UClass*> AllPoolFactories;
+	UPoolManagerSettings::Get().GetPoolFactories(/*out*/AllPoolFactories);
 	for (UClass* FactoryClass : AllPoolFactories)
 	{
-		AddFactory(FactoryClass);
+		AddFactory(FactoryClass);
+	}
+}
+
+// Destroys all Pool Factories that are used by the Pool Manager when dealing with objects
+void UPoolManagerSubsystem::ClearAllFactories()
+{
+	for (const TTuple<TObjectPtr<const UClass>, TObjectPtr<UPoolFactory_UObject>>& FactoryIt : AllFactoriesInternal)
+	{
+		if (IsValid(FactoryIt.Value))
+		{
+			FactoryIt.Value->ConditionalBeginDestroy();
+		}
+	}
+
+	AllFactoriesInternal.Empty();
+}
+
+/*********************************************************************************************
+ * Advanced - Travel
+ ********************************************************************************************* */
+
+// Adds all free pooled actors that can travel to the next world
+void UPoolManagerSubsystem::GetSeamlessTravelActors(TArray<AActor*>& InOutActorList) const
+{
+	if (!UPoolManagerPersistentSubsystem::GetPersistentStore(this))
+	{
+		// Persistence is disabled, travelled actors would not be adopted by the next world
+		return;
+	}
+
+	for (const FPoolContainer& PoolIt : PoolsInternal)
+	{
+		if (!PoolIt.ObjectClass
+			|| !PoolIt.ObjectClass->IsChildOf<AActor>())
+		{
+			continue;
+		}
+
+		for (const FPoolObjectData& DataIt : PoolIt.PoolObjects)
+		{
+			AActor* Actor = DataIt.IsFree() ? DataIt.Get<AActor>() : nullptr;
+			if (IsValid(Actor)
+				&& !Actor->IsNetStartupActor()) // Startup actors belong to the level and can't travel
+			{
+				InOutActorList.AddUnique(Actor);
+			}
+		}
+	}
+}
+
+// Keeps free objects in the game instance, so they are adopted by the next world's Pool Manager instead of being destroyed
+void UPoolManagerSubsystem::StashPoolsForTravel()
+{
+	UPoolManagerPersistentSubsystem* PersistentStore = UPoolManagerPersistentSubsystem::GetPersistentStore(this);
+	if (!PersistentStore)
+	{
+		return;
+	}
+
+	for (const FPoolContainer& PoolIt : PoolsInternal)
+	{
+		const UPoolFactory_UObject& Factory = PoolIt.GetFactoryChecked();
+		for (const FPoolObjectData& DataIt : PoolIt.PoolObjects)
+		{
+			if (DataIt.IsFree()
+				&& Factory.CanPersistAcrossTravel(DataIt.Get()))
+			{
+				PersistentStore->StashObject(DataIt);
+			}
+		}
+	}
+
+	PoolsInternal.Empty();
+}
+
+// Registers free objects that were kept from the previous world
+void UPoolManagerSubsystem::AdoptPoolsAfterTravel()
+{
+	if (UPoolManagerPersistentSubsystem* PersistentStore = UPoolManagerPersistentSubsystem::GetPersistentStore(this))
+	{
+		PersistentStore->AdoptObjects(*this);
+	}
+}
+
+/*********************************************************************************************
+ * Advanced - Streaming
+ ********************************************************************************************* */
+
+// Creates free objects next frames in advance, so they are ready to be taken with no spawn
+int32 UPoolManagerSubsystem::PrewarmPool(const UClass* ObjectClass, int32 Amount, ESpawnRequestPriority Priority/* = ESpawnRequestPriority::Normal*/)
+{
+	if (!ensureMsgf(ObjectClass, TEXT("ASSERT: [%i] %hs:\n'ObjectClass' is null!"), __LINE__, __FUNCTION__))
+	{
+		return 0;
+	}
+
+	// Scale by current scalability, e.g: low-end devices pre-warm less
+	Amount = FMath::CeilToInt32(Amount * UPoolManagerSettings::Get().GetPrewarmMultiplier());
+
+	// Pool that is being shrunk should not go below pre-warmed amount
+	if (int32* ShrinkAmount = ShrinkingPoolsInternal.Find(ObjectClass))
+	{
+		*ShrinkAmount = FMath::Max(*ShrinkAmount, Amount);
+	}
+
+	const FPoolContainer& Pool = FindPoolOrAdd(ObjectClass);
+	const int32 ExistingNum = GetRegisteredObjectsNum(ObjectClass) + Pool.GetFactoryChecked().GetSpawnRequestsNum(ObjectClass);
+	int32 NewNum = Amount - ExistingNum;
+
+	// Don't spawn objects that would be destroyed right away by the budget
+	const int32 MaxFreeObjectsNum = UPoolManagerSettings::Get().GetMaxFreeObjectsPerPool();
+	if (MaxFreeObjectsNum >= 0)
+	{
+		NewNum = FMath::Min(NewNum, MaxFreeObjectsNum - GetFreeObjectsNum(ObjectClass));
+	}
+
+	if (NewNum <= 0)
+	{
+		// Already contains enough objects
+		return 0;
+	}
+
+	TArray<FSpawnRequest> Requests;
+	FSpawnRequest::MakeRequests(/*out*/Requests, ObjectClass, NewNum, Priority);
+	for (FSpawnRequest& RequestIt : Requests)
+	{
+		RequestIt.bIsPrewarm = true;
+	}
+
+	TArray<FPoolObjectHandle> Handles;
+	CreateNewObjectsArrayInPool(Requests, /*out*/Handles);
+
+	return NewNum;
+}
+
+// Destroys free objects next frames until the pool contains specified amount of objects
+void UPoolManagerSubsystem::ShrinkPool(const UClass* ObjectClass, int32 Amount)
+{
+	FPoolContainer* Pool = ObjectClass ? FindPool(ObjectClass) : nullptr;
+	if (!Pool)
+	{
+		return;
+	}
+
+	Amount = FMath::Max(Amount, 0);
+	UPoolFactory_UObject& Factory = Pool->GetFactoryChecked();
+	const int32 ExcessNum = GetRegisteredObjectsNum(ObjectClass) + Factory.GetSpawnRequestsNum(ObjectClass) - Amount;
+	if (ExcessNum <= 0)
+	{
+		ShrinkingPoolsInternal.Remove(ObjectClass);
+		return;
+	}
+
+	// Cancel pre-warming that is not spawned yet, so nothing is spawned just to be destroyed
+	Factory.CancelPrewarmRequests(ObjectClass, ExcessNum);
+
+	const bool bIsAlreadyShrinking = !ShrinkingPoolsInternal.IsEmpty();
+	ShrinkingPoolsInternal.Add(ObjectClass, Amount);
+
+	// Destroying many actors at once causes hitches as well as spawning, so defer it to next frames
+	if (!bIsAlreadyShrinking)
+	{
+		const UWorld* World = GetWorld();
+		checkf(World, TEXT("ERROR: [%i] %hs:\n'World' is null!"), __LINE__, __FUNCTION__);
+		World->GetTimerManager().SetTimerForNextTick(this, &ThisClass::OnNextTickProcessShrink);
+	}
+}
+
+// Pre-warms or shrinks the pool to exactly specified amount of objects
+int32 UPoolManagerSubsystem::ResizePool(const UClass* ObjectClass, int32 Amount)
+{
+	if (!ensureMsgf(ObjectClass, TEXT("ASSERT: [%i] %hs:\n'ObjectClass' is null!"), __LINE__, __FUNCTION__))
+	{
+		return 0;
+	}
+
+	Amount = FMath::Max(Amount, 0);
+	const FPoolContainer& Pool = FindPoolOrAdd(ObjectClass);
+	const int32 NewNum = Amount - GetRegisteredObjectsNum(ObjectClass) - Pool.GetFactoryChecked().GetSpawnRequestsNum(ObjectClass);
+	if (NewNum <= 0)
+	{
+		ShrinkPool(ObjectClass, Amount);
+		return 0;
+	}
+
+	// Pool that is being shrunk should not go below new amount
+	if (int32* ShrinkAmount = ShrinkingPoolsInternal.Find(ObjectClass))
+	{
+		*ShrinkAmount = FMath::Max(*ShrinkAmount, Amount);
+	}
+
+	TArray<FSpawnRequest> Requests;
+	FSpawnRequest::MakeRequests(/*out*/Requests, ObjectClass, NewNum, ESpawnRequestPriority::Normal);
+	for (FSpawnRequest& RequestIt : Requests)
+	{
+		RequestIt.bIsPrewarm = true;
+	}
+
+	TArray<FPoolObjectHandle> Handles;
+	CreateNewObjectsArrayInPool(Requests, /*out*/Handles);
+
+	return NewNum;
+}
+
+// Ties the pool to the streaming level or data layer
+void UPoolManagerSubsystem::AddStreamingPool(const FPoolStreamingBinding& Binding)
+{
+	if (!ensureMsgf(Binding.IsValid(), TEXT("ASSERT: [%i] %hs:\n'Binding' has to contain the class and the level or data layer!"), __LINE__, __FUNCTION__))
+	{
+		return;
+	}
+
+	FPoolStreamingBinding* FoundBinding = StreamingPoolsInternal.FindByKey(Binding);
+	if (!FoundBinding)
+	{
+		FoundBinding = &StreamingPoolsInternal.Emplace_GetRef(Binding);
+	}
+
+	const bool bShrink = FoundBinding->bIsLoaded && Binding.Amount < FoundBinding->Amount;
+	FoundBinding->Amount = Binding.Amount;
+	FoundBinding->Priority = Binding.Priority;
+	FoundBinding->bIsLoaded = IsStreamingSourceLoaded(*FoundBinding);
+
+	UpdateStreamingPool(Binding.ObjectClass, bShrink);
+}
+
+// Unties the pool from given streaming level or data layer
+void UPoolManagerSubsystem::RemoveStreamingPool(const FPoolStreamingBinding& Binding)
+{
+	if (StreamingPoolsInternal.Remove(Binding) > 0)
+	{
+		constexpr bool bShrink = true;
+		UpdateStreamingPool(Binding.ObjectClass, bShrink);
+	}
+}
+
+// Returns the amount of objects of given class that is required by all loaded streaming bindings
+int32 UPoolManagerSubsystem::GetStreamingPoolAmount(const UClass* ObjectClass) const
+{
+	int32 Amount = 0;
+	for (const FPoolStreamingBinding& BindingIt : StreamingPoolsInternal)
+	{
+		if (BindingIt.bIsLoaded
+			&& BindingIt.ObjectClass == ObjectClass)
+		{
+			Amount += BindingIt.Amount;
+		}
+	}
+	return Amount;
+}
+
+// Pre-warms the pool of given class to the amount required by loaded streaming bindings
+void UPoolManagerSubsystem::UpdateStreamingPool(const UClass* ObjectClass, bool bShrink)
+{
+	if (!ObjectClass)
+	{
+		return;
+	}
+
+	const int32 Amount = GetStreamingPoolAmount(ObjectClass);
+
+	if (bShrink)
+	{
+		// Is scaled the same way as pre-warmed amount
+		ShrinkPool(ObjectClass, FMath::CeilToInt32(Amount * UPoolManagerSettings::Get().GetPrewarmMultiplier()));
+	}
+
+	if (Amount > 0)
+	{
+		// Use the highest priority of all loaded bindings
+		ESpawnRequestPriority Priority = ESpawnRequestPriority::Normal;
+		for (const FPoolStreamingBinding& BindingIt : StreamingPoolsInternal)
+		{
+			if (BindingIt.bIsLoaded
+				&& BindingIt.ObjectClass == ObjectClass)
+			{
+				Priority = FMath::Max(Priority, BindingIt.Priority);
+			}
+		}
+
+		PrewarmPool(ObjectClass, Amount, Priority);
+	}
+}
+
+// Updates loaded state of all streaming bindings and their pools
+void UPoolManagerSubsystem::RefreshStreamingPools(const ULevel* UnloadingLevel/* = nullptr*/)
+{
+	TArray<const UClass*> LoadedClasses;
+	TArray<const UClass*> UnloadedClasses;
+	for (FPoolStreamingBinding& BindingIt : StreamingPoolsInternal)
+	{
+		const bool bIsLoaded = IsStreamingSourceLoaded(BindingIt, UnloadingLevel);
+		if (BindingIt.bIsLoaded == bIsLoaded)
+		{
+			continue;
+		}
+
+		BindingIt.bIsLoaded = bIsLoaded;
+		TArray<const UClass*>& ChangedClasses = bIsLoaded ? LoadedClasses : UnloadedClasses;
+		ChangedClasses.AddUnique(BindingIt.ObjectClass);
+	}
+
+	for (const UClass* ClassIt : UnloadedClasses)
+	{
+		constexpr bool bShrink = true;
+		UpdateStreamingPool(ClassIt, bShrink);
+	}
+
+	for (const UClass* ClassIt : LoadedClasses)
+	{
+		if (!UnloadedClasses.Contains(ClassIt))
+		{
+			constexpr bool bShrink = false;
+			UpdateStreamingPool(ClassIt, bShrink);
+		}
+	}
+}
+
+// Returns true if the level or data layer of given binding is loaded in this world
+bool UPoolManagerSubsystem::IsStreamingSourceLoaded(const FPoolStreamingBinding& Binding, const ULevel* UnloadingLevel/* = nullptr*/) const
+{
+	const UWorld* World = GetWorld();
+	if (!World)
+	{
+		return false;
+	}
+
+	if (Binding.DataLayer)
+	{
+		const UDataLayerManager* DataLayerManager = UDataLayerManager::GetDataLayerManager(World);
+		const UDataLayerInstance* DataLayerInstance = DataLayerManager ? DataLayerManager->GetDataLayerInstanceFromAsset(Binding.DataLayer) : nullptr;
+		if (DataLayerInstance
+			&& DataLayerInstance->GetEffectiveRuntimeState() != EDataLayerRuntimeState::Unloaded)
+		{
+			return true;
+		}
+	}
+
+	if (!Binding.Level.IsNull())
+	{
+		const FString LevelPackageName = Binding.Level.GetLongPackageName();
+		for (const ULevel* LevelIt : World->GetLevels())
+		{
+			if (LevelIt
+				&& LevelIt != UnloadingLevel
+				&& LevelIt->bIsVisible
+				&& UWorld::RemovePIEPrefix(LevelIt->GetOutermost()->GetName()) == LevelPackageName)
+			{
+				return true;
+			}
+		}
+	}
+
+	return false;
+}
+
+// Is called on next frame to destroy a chunk of free objects of shrinking pools
+void UPoolManagerSubsystem::OnNextTickProcessShrink()
+{
+	int32 ObjectsPerFrame = GetSpawnObjectsPerFrame();
+	if (!ensureMsgf(ObjectsPerFrame >= 1, TEXT("ASSERT: [%i] %hs:\n'ObjectsPerFrame' is less than 1, set the config!"), __LINE__, __FUNCTION__))
+	{
+		ObjectsPerFrame = 1;
+	}
+
+	for (TMap<TObjectPtr<const UClass>, int32>::TIterator It = ShrinkingPoolsInternal.CreateIterator(); It && ObjectsPerFrame > 0; ++It)
+	{
+		FPoolContainer* Pool = PoolsInternal.FindByKey(It.Key());
+		if (!Pool)
+		{
+			// Pool was emptied meanwhile
+			It.RemoveCurrent();
+			continue;
+		}
+
+		UPoolFactory_UObject& Factory = Pool->GetFactoryChecked();
+		TArray<FPoolObjectData>& PoolObjects = Pool->PoolObjects;
+		int32 ExcessNum = PoolObjects.Num() - It.Value();
+		for (int32 Index = PoolObjects.Num() - 1; Index >= 0 && ExcessNum > 0 && ObjectsPerFrame > 0; --Index)
+		{
+			const FPoolObjectData& DataIt = PoolObjects[Index];
+			if (DataIt.bIsActive)
+			{
+				continue;
+			}
+
+			UObject* ObjectIt = DataIt.Get();
+			if (IsValid(ObjectIt))
+			{
+				Factory.Destroy(ObjectIt);
+				--ObjectsPerFrame;
+			}
+
+			PoolObjects.RemoveAt(Index);
+			--ExcessNum;
+		}
+
+		// Indices of active objects are shifted by removed free ones
+		Pool->RebuildActiveIndices();
+
+		// Is finished when the excess is destroyed or when only active objects are left, they are not destroyed
+		if (ExcessNum <= 0
+			|| ObjectsPerFrame > 0)
+		{
+			It.RemoveCurrent();
+		}
+	}
+
+	if (!ShrinkingPoolsInternal.IsEmpty())
+	{
+		const UWorld* World = GetWorld();
+		checkf(World, TEXT("ERROR: [%i] %hs:\n'World' is null!"), __LINE__, __FUNCTION__);
+		World->GetTimerManager().SetTimerForNextTick(this, &ThisClass::OnNextTickProcessShrink);
+	}
+}
+
+// Is called when any level becomes visible in any world
+void UPoolManagerSubsystem::OnLevelAddedToWorld(ULevel* Level, UWorld* World)
+{
+	if (World == GetWorld())
+	{
+		RefreshStreamingPools();
+	}
+}
+
+// Is called when any level is removed from any world
+void UPoolManagerSubsystem::OnLevelRemovedFromWorld(ULevel* Level, UWorld* World)
+{
+	// Null level means the whole world is being cleaned up, pools are destroyed with it anyway
+	if (Level
+		&& World == GetWorld())
+	{
+		RefreshStreamingPools(Level);
+	}
+}
+
+// Is called when runtime state of any data layer is changed in this world
+void UPoolManagerSubsystem::OnDataLayerRuntimeStateChanged(const UDataLayerInstance* DataLayer, EDataLayerRuntimeState State)
+{
+	RefreshStreamingPools();
+}
+
+/*********************************************************************************************
+ * Advanced - Budget
+ ********************************************************************************************* */
+
+// Sets the mode that affects how many objects are spawned per frame
+void UPoolManagerSubsystem::SetSpawnBudgetMode(EPoolSpawnBudgetMode NewMode)
+{
+	SpawnBudgetModeInternal = NewMode;
+}
+
+// Returns a limit of how many objects to spawn per frame according to current budget mode
+int32 UPoolManagerSubsystem::GetSpawnObjectsPerFrame() const
+{
+	const UPoolManagerSettings& Settings = UPoolManagerSettings::Get();
+	switch (SpawnBudgetModeInternal)
+	{
+	case EPoolSpawnBudgetMode::Loading:
+		return FMath::Max(Settings.GetLoadingSpawnObjectsPerFrame(), Settings.GetSpawnObjectsPerFrame());
+
+	case EPoolSpawnBudgetMode::Gameplay: // Fall-through
+	default:
+		return Settings.GetSpawnObjectsPerFrame();
+	}
+}
+
+// Returns milliseconds that spawning can take per frame according to current budget mode
+float UPoolManagerSubsystem::GetSpawnBudgetMs() const
+{
+	return SpawnBudgetModeInternal == EPoolSpawnBudgetMode::Gameplay ? UPoolManagerSettings::Get().GetSpawnBudgetMs() : 0.f;
+}
+
+// Returns measured spawn, take and return costs of objects of given class
+FPoolSpawnCost UPoolManagerSubsystem::GetSpawnCost(const UClass* ObjectClass) const
+{
+	const UPoolFactory_UObject* Factory = ObjectClass ? FindPoolFactoryChecked(ObjectClass) : nullptr;
+	return Factory ? Factory->GetSpawnCost(ObjectClass) : FPoolSpawnCost();
+}
+
+// Destroys free objects above 'PoolManager.MaxFreeObjectsPerPool' and 'PoolManager.MemoryBudgetMB' limits
+void UPoolManagerSubsystem::EnforcePoolBudgets()
+{
+	bIsEnforcePoolBudgetsPendingInternal = false;
+
+	const UPoolManagerSettings& Settings = UPoolManagerSettings::Get();
+	const int32 MaxFreeObjectsNum = Settings.GetMaxFreeObjectsPerPool();
+	const int64 MemoryBudgetBytes = static_cast<int64>(Settings.GetMemoryBudgetMB() * 1024.f * 1024.f);
+	if (MaxFreeObjectsNum < 0
+		&& MemoryBudgetBytes <= 0)
+	{
+		// Budgets are unlimited
+		return;
+	}
+
+	// Find how many free objects each pool can keep
+	const int32 PoolsNum = PoolsInternal.Num();
+	TArray<int32> FreeObjectsNums;
+	TArray<int32> KeepObjectsNums;
+	FreeObjectsNums.Reserve(PoolsNum);
+	KeepObjectsNums.Reserve(PoolsNum);
+	int64 TotalFreeBytes = 0;
+	for (const FPoolContainer& PoolIt : PoolsInternal)
+	{
+		const int32 FreeObjectsNum = GetFreeObjectsNum(PoolIt.ObjectClass);
+		const int32 KeepObjectsNum = MaxFreeObjectsNum >= 0 ? FMath::Min(FreeObjectsNum, MaxFreeObjectsNum) : FreeObjectsNum;
+		FreeObjectsNums.Emplace(FreeObjectsNum);
+		KeepObjectsNums.Emplace(KeepObjectsNum);
+		TotalFreeBytes += KeepObjectsNum * PoolIt.ObjectSizeBytes;
+	}
+
+	if (MemoryBudgetBytes > 0
+		&& TotalFreeBytes > MemoryBudgetBytes)
+	{
+		// Drop free objects of the heaviest pools first
+		TArray<int32> SortedIndices;
+		SortedIndices.Reserve(PoolsNum);
+		for (int32 Index = 0; Index < PoolsNum; ++Index)
+		{
+			SortedIndices.Emplace(Index);
+		}
+		SortedIndices.Sort([this, &KeepObjectsNums](int32 A, int32 B)
+		{
+			return KeepObjectsNums[A] * PoolsInternal[A].ObjectSizeBytes > KeepObjectsNums[B] * PoolsInternal[B].ObjectSizeBytes;
+		});
+
+		for (const int32 Index : SortedIndices)
+		{
+			if (TotalFreeBytes <= MemoryBudgetBytes)
+			{
+				break;
+			}
+
+			const int64 ObjectSizeBytes = PoolsInternal[Index].ObjectSizeBytes;
+			if (ObjectSizeBytes <= 0)
+			{
+				continue;
+			}
+
+			const int64 ExcessObjectsNum = FMath::DivideAndRoundUp(TotalFreeBytes - MemoryBudgetBytes, ObjectSizeBytes);
+			const int32 DropObjectsNum = static_cast<int32>(FMath::Min<int64>(KeepObjectsNums[Index], ExcessObjectsNum));
+			KeepObjectsNums[Index] -= DropObjectsNum;
+			TotalFreeBytes -= DropObjectsNum * ObjectSizeBytes;
+		}
+	}
+
+	// Pools are shrunk by classes since ShrinkPool() could change the order of pools
+	TArray<TPair<const UClass*, int32>> PoolsToShrink;
+	for (int32 Index = 0; Index < PoolsNum; ++Index)
+	{
+		const int32 DropObjectsNum = FreeObjectsNums[Index] - KeepObjectsNums[Index];
+		if (DropObjectsNum > 0)
+		{
+			const UClass* ObjectClass = PoolsInternal[Index].ObjectClass;
+			PoolsToShrink.Emplace(ObjectClass, GetRegisteredObjectsNum(ObjectClass) - DropObjectsNum);
+		}
+	}
+
+	for (const TPair<const UClass*, int32>& It : PoolsToShrink)
+	{
+		ShrinkPool(It.Key, It.Value);
+	}
+}
+
+// Returns estimated memory in bytes used by objects of given pool
+int64 UPoolManagerSubsystem::GetPoolMemorySize(const UClass* ObjectClass, bool bFreeOnly/* = false*/) const
+{
+	const FPoolContainer* Pool = ObjectClass ? FindPool(ObjectClass) : nullptr;
+	if (!Pool)
+	{
+		return 0;
+	}
+
+	const int32 ObjectsNum = bFreeOnly ? GetFreeObjectsNum(ObjectClass) : GetRegisteredObjectsNum(ObjectClass);
+	return ObjectsNum * Pool->ObjectSizeBytes;
+}
+
+// Is called when any budget console variable is changed to adjust pools live
+void UPoolManagerSubsystem::OnPoolBudgetsChanged()
+{
+	// Streaming pools are pre-warmed or shrunk by the new multiplier
+	TArray<const UClass*> StreamingClasses;
+	for (const FPoolStreamingBinding& BindingIt : StreamingPoolsInternal)
+	{
+		StreamingClasses.AddUnique(BindingIt.ObjectClass);
+	}
+
+	for (const UClass* ClassIt : StreamingClasses)
+	{
+		constexpr bool bShrink = true;
+		UpdateStreamingPool(ClassIt, bShrink);
+	}
+
+	EnforcePoolBudgets();
+}
+
+// Schedules EnforcePoolBudgets() to next frame if any budget is limited
+void UPoolManagerSubsystem::RequestEnforcePoolBudgets()
+{
+	const UPoolManagerSettings& Settings = UPoolManagerSettings::Get();
+	const UWorld* World = GetWorld();
+	if (bIsEnforcePoolBudgetsPendingInternal
+		|| !World
+		|| (Settings.GetMaxFreeObjectsPerPool() < 0 && Settings.GetMemoryBudgetMB() <= 0.f))
+	{
+		return;
+	}
+
+	bIsEnforcePoolBudgetsPendingInternal = true;
+	World->GetTimerManager().SetTimerForNextTick(this, &ThisClass::EnforcePoolBudgets);
+}
+
+// Spawns queued requests of all factories right now up to the loading budget
+void UPoolManagerSubsystem::ProcessLoadingSpawnBudget()
+{
+	if (SpawnBudgetModeInternal != EPoolSpawnBudgetMode::Loading)
+	{
+		return;
+	}
+
+	const int32 ObjectsPerFrame = GetSpawnObjectsPerFrame();
+	for (const TTuple<TObjectPtr<const UClass>, TObjectPtr<UPoolFactory_UObject>>& It : AllFactoriesInternal)
+	{
+		UPoolFactory_UObject* Factory = It.Value;
+		for (int32 Index = 0; Factory && Index < ObjectsPerFrame && !Factory->IsSpawnQueueEmpty(); ++Index)
+		{
+			FSpawnRequest OutRequest;
+			if (Factory->DequeueSpawnRequest(OutRequest))
+			{
+				Factory->ProcessRequestNow(OutRequest);
+			}
+		}
+	}
+}
+
+// Is called when the loading screen movie is finished to switch back to the gameplay budget
+void UPoolManagerSubsystem::OnLoadingScreenFinished()
+{
+	if (IGameMoviePlayer* MoviePlayer = GetMoviePlayer())
+	{
+		MoviePlayer->OnMoviePlaybackFinished().RemoveAll(this);
+	}
+
+	SetSpawnBudgetMode(EPoolSpawnBudgetMode::Gameplay);
+}
+
+/*********************************************************************************************
+ * Advanced - Stats
+ ********************************************************************************************* */
+
+// Returns approximate percentile of given latency metric of the pool
+float UPoolManagerSubsystem::GetPoolLatencyPercentile(const UClass* ObjectClass, EPoolLatencyMetric Metric, float Percentile/* = 0.95f*/) const
+{
+	const FPoolLatencyStats* Stats = GetPoolLatencyStats(ObjectClass);
+	if (!Stats)
+	{
+		return 0.f;
+	}
+
+	const uint64 Value = Stats->GetHistogram(Metric).GetPercentile(Percentile);
+	return Metric == EPoolLatencyMetric::QueueWaitFrames
+		       ? static_cast<float>(Value)
+		       : static_cast<float>(Value) / 1000.f; // Microseconds to milliseconds
+}
+
+// Returns latency histograms of the pool, or null if the pool is not registered
+const FPoolLatencyStats* UPoolManagerSubsystem::GetPoolLatencyStats(const UClass* ObjectClass) const
+{
+	const FPoolContainer* Pool = ObjectClass ? FindPool(ObjectClass) : nullptr;
+	return Pool ? &Pool->LatencyStats : nullptr;
+}
+
+// Removes collected hits, misses and latency samples of all pools
+void UPoolManagerSubsystem::ResetPoolStats()
+{
+	for (FPoolContainer& PoolIt : PoolsInternal)
+	{
+		PoolIt.HitsNum = 0;
+		PoolIt.MissesNum = 0;
+		PoolIt.LatencyStats.Reset();
+	}
+
+	// Counters of the take history are relative to the totals of pools
+	TakeHistoryInternal.Empty();
+}
+
+// Prints hits, misses and latency percentiles of all pools to given output device
+void UPoolManagerSubsystem::LogPoolStats(FOutputDevice& Ar) const
+{
+	Ar.Logf(TEXT("Pool stats of '%s':"), *GetNameSafe(GetWorld()));
+	Ar.Logf(TEXT("%-40s %8s %8s %7s %14s %14s %14s %12s"), TEXT("Class"), TEXT("Hits"), TEXT("Misses"), TEXT("Hit %"),
+	        TEXT("Wait p50/p95 f"), TEXT("Wait p95 ms"), TEXT("Spawn p50/p95"), TEXT("Life p50 s"));
+
+	for (const FPoolContainer& PoolIt : PoolsInternal)
+	{
+		if (!PoolIt.ObjectClass)
+		{
+			continue;
+		}
+
+		const FPoolLatencyStats& Stats = PoolIt.LatencyStats;
+		Ar.Logf(TEXT("%-40s %8i %8i %6.1f%% %6llu/%-7llu %14.2f %6.2f/%-7.2f %12.1f"),
+		        *PoolIt.ObjectClass->GetName(), PoolIt.HitsNum, PoolIt.MissesNum, PoolIt.GetHitRate() * 100.f,
+		        Stats.QueueWaitFrames.GetPercentile(0.5f), Stats.QueueWaitFrames.GetPercentile(0.95f),
+		        Stats.QueueWaitMicroseconds.GetPercentile(0.95f) / 1000.f,
+		        Stats.SpawnMicroseconds.GetPercentile(0.5f) / 1000.f, Stats.SpawnMicroseconds.GetPercentile(0.95f) / 1000.f,
+		        Stats.LifetimeMicroseconds.GetPercentile(0.5f) / 1000000.f);
+	}
+}
+
+// Adds queue wait and spawn duration of given request to the stats of its pool
+void UPoolManagerSubsystem::RecordSpawnLatency(const FSpawnRequest& Request, double SpawnSeconds)
+{
+	FPoolContainer* Pool = Request.GetClass() ? FindPool(Request.GetClass()) : nullptr;
+	if (!Pool)
+	{
+		return;
+	}
+
+	FPoolLatencyStats& Stats = Pool->LatencyStats;
+	Stats.SpawnMicroseconds.AddSample(static_cast<uint64>(FMath::Max(SpawnSeconds, 0.0) * 1000000.0));
+
+	// Nobody waits for pre-warmed objects, so only taken ones affect the queue wait
+	if (!Request.bIsPrewarm
+		&& Request.RequestedTime > 0.0)
+	{
+		Stats.QueueWaitFrames.AddSample(GFrameCounter - Request.RequestedFrame);
+		const double WaitSeconds = FPlatformTime::Seconds() - Request.RequestedTime - SpawnSeconds;
+		Stats.QueueWaitMicroseconds.AddSample(static_cast<uint64>(FMath::Max(WaitSeconds, 0.0) * 1000000.0));
+	}
+}
+
+/*********************************************************************************************
+ * Advanced - Leaks
+ ********************************************************************************************* */
+
+// Overrides seconds after which active objects of given class and its children are reported as leaked
+void UPoolManagerSubsystem::SetLeakThreshold(const UClass* ObjectClass, float ThresholdSeconds)
+{
+	if (!ensureMsgf(ObjectClass, TEXT("ASSERT: [%i] %hs:\n'ObjectClass' is null!"), __LINE__, __FUNCTION__))
+	{
+		return;
+	}
+
+	if (ThresholdSeconds < 0.f)
+	{
+		LeakThresholdsInternal.Remove(ObjectClass);
+	}
+	else
+	{
+		LeakThresholdsInternal.Emplace(ObjectClass, ThresholdSeconds);
 	}
 }
 
-// Destroys all Pool Factories that are used by the Pool Manager when dealing with objects
-void UPoolManagerSubsystem::ClearAllFactories()
+// Returns seconds after which active objects of given class are reported as leaked, 0 if never
+float UPoolManagerSubsystem::GetLeakThreshold(const UClass* ObjectClass) const
 {
-	for (const TTuple<TObjectPtr<const UClass>, TObjectPtr<UPoolFactory_UObject>>& FactoryIt : AllFactoriesInternal)
+	// The closest parent class with overridden threshold is used
+	for (const UClass* ClassIt = ObjectClass; ClassIt; ClassIt = ClassIt->GetSuperClass())
 	{
-		if (IsValid(FactoryIt.Value))
+		if (const float* Threshold = LeakThresholdsInternal.Find(ClassIt))
 		{
-			FactoryIt.Value->ConditionalBeginDestroy();
+			return *Threshold;
 		}
 	}
 
-	AllFactoriesInternal.Empty();
+	return UPoolManagerSettings::Get().GetLeakThresholdSeconds();
+}
+
+// Returns all active objects that are not returned to the pool longer than their leak threshold
+void UPoolManagerSubsystem::GetLeakedObjects(TArray<FPoolObjectData>& OutObjects) const
+{
+	if (!OutObjects.IsEmpty())
+	{
+		OutObjects.Empty();
+	}
+
+	const double CurrentTime = FPlatformTime::Seconds();
+	for (const FPoolContainer& PoolIt : PoolsInternal)
+	{
+		const float Threshold = GetLeakThreshold(PoolIt.ObjectClass);
+		if (Threshold <= 0.f)
+		{
+			continue;
+		}
+
+		for (const int32 IndexIt : PoolIt.ActiveIndices)
+		{
+			const FPoolObjectData& DataIt = PoolIt.PoolObjects[IndexIt];
+			if (DataIt.IsActive()
+				&& DataIt.TakenTime > 0.0
+				&& CurrentTime - DataIt.TakenTime > Threshold)
+			{
+				OutObjects.Emplace(DataIt);
+			}
+		}
+	}
+}
+
+// Logs a warning once for each newly leaked object
+void UPoolManagerSubsystem::DetectLeaks()
+{
+	const double CurrentTime = FPlatformTime::Seconds();
+	for (FPoolContainer& PoolIt : PoolsInternal)
+	{
+		const float Threshold = GetLeakThreshold(PoolIt.ObjectClass);
+		if (Threshold <= 0.f)
+		{
+			continue;
+		}
+
+		for (const int32 IndexIt : PoolIt.ActiveIndices)
+		{
+			FPoolObjectData& DataIt = PoolIt.PoolObjects[IndexIt];
+			if (!DataIt.bIsLeakReported
+				&& DataIt.IsActive()
+				&& DataIt.TakenTime > 0.0
+				&& CurrentTime - DataIt.TakenTime > Threshold)
+			{
+				DataIt.bIsLeakReported = true;
+				UE_LOG(LogPoolManager, Warning, TEXT("'%s' is active for %.0f seconds that is more than its leak threshold of %.0f seconds, is it never returned to the pool? See 'PoolManager.LeakReport'"),
+				       *GetNameSafe(DataIt.Get()), CurrentTime - DataIt.TakenTime, Threshold);
+			}
+		}
+	}
+}
+
+#if !UE_BUILD_SHIPPING
+// Returns the callsite of the Blueprint function that is calling the take node right now and remembers its script callstack
+uint64 UPoolManagerSubsystem::RecordScriptCallsite()
+{
+#if DO_BLUEPRINT_GUARD
+	const TArrayView<const FFrame* const> ScriptStack = FBlueprintContextTracker::Get().GetCurrentScriptStack();
+	const FFrame* CallerFrame = !ScriptStack.IsEmpty() ? ScriptStack.Last() : nullptr;
+	if (!CallerFrame
+		|| !CallerFrame->Node)
+	{
+		// Is not called by Blueprint
+		return 0;
+	}
+
+	// Offset of the node in the function, so different take nodes of the same event graph are different callsites
+	const uint32 CodeOffset = static_cast<uint32>(CallerFrame->Code - CallerFrame->Node->Script.GetData());
+	const uint64 Callsite = static_cast<uint64>(PointerHash(CallerFrame->Node)) << 32 | CodeOffset;
+	if (!ScriptCallsitesInternal.Contains(Callsite))
+	{
+		// Callstack is built only once per callsite, so taking from Blueprints stays cheap
+		constexpr bool bReturnEmpty = true;
+		ScriptCallsitesInternal.Emplace(Callsite, FFrame::GetScriptCallstack(bReturnEmpty));
+	}
+
+	return Callsite;
+#else
+	return 0;
+#endif // DO_BLUEPRINT_GUARD
+}
+#endif // !UE_BUILD_SHIPPING
+
+// Prints all leaked objects grouped by callsites that took them
+void UPoolManagerSubsystem::LogLeakReport(FOutputDevice& Ar) const
+{
+	TArray<FPoolObjectData> LeakedObjects;
+	GetLeakedObjects(/*out*/LeakedObjects);
+
+	TMap<uint64, TArray<const FPoolObjectData*>> LeaksByCallsites;
+	for (const FPoolObjectData& DataIt : LeakedObjects)
+	{
+		LeaksByCallsites.FindOrAdd(DataIt.TakeCallsite).Emplace(&DataIt);
+	}
+
+	// Callsites with the most leaks are printed first
+	LeaksByCallsites.ValueSort([](const TArray<const FPoolObjectData*>& A, const TArray<const FPoolObjectData*>& B)
+	{
+		return A.Num() > B.Num();
+	});
+
+	Ar.Logf(TEXT("Leaks of '%s': %i objects from %i callsites"), *GetNameSafe(GetWorld()), LeakedObjects.Num(), LeaksByCallsites.Num());
+
+	const double CurrentTime = FPlatformTime::Seconds();
+	for (const TTuple<uint64, TArray<const FPoolObjectData*>>& It : LeaksByCallsites)
+	{
+		// Symbols are resolved only here, so recording of callsites stays cheap
+		FString CallsiteName = TEXT("Unknown callsite");
+#if !UE_BUILD_SHIPPING
+		if (const FString* ScriptCallstack = ScriptCallsitesInternal.Find(It.Key))
+		{
+			CallsiteName = *ScriptCallstack;
+		}
+		else if (It.Key)
+		{
+			ANSICHAR SymbolName[1024] = {};
+			FPlatformStackWalk::InitStackWalking();
+			FPlatformStackWalk::ProgramCounterToHumanReadableString(0, It.Key, SymbolName, UE_ARRAY_COUNT(SymbolName));
+			CallsiteName = ANSI_TO_TCHAR(SymbolName);
+		}
+#endif // !UE_BUILD_SHIPPING
+
+		Ar.Logf(TEXT("%i objects taken at %s"), It.Value.Num(), *CallsiteName);
+		for (const FPoolObjectData* DataIt : It.Value)
+		{
+			Ar.Logf(TEXT("    %-48s active for %.0f seconds"), *GetNameSafe(DataIt->Get()), CurrentTime - DataIt->TakenTime);
+		}
+	}
+}
+
+/*********************************************************************************************
+ * Advanced - Owners
+ ********************************************************************************************* */
+
+// Binds taken object to given owner, so it is returned to the pool once the owner is destroyed or ReturnAllOwnedBy() is called
+void UPoolManagerSubsystem::AssignOwner(const FPoolObjectHandle& Handle, UObject* Owner)
+{
+	if (!ensureMsgf(Handle.IsValid(), TEXT("ASSERT: [%i] %hs:\n'Handle' is not valid!"), __LINE__, __FUNCTION__))
+	{
+		return;
+	}
+
+	ReleaseOwner(Handle);
+
+	if (!Owner)
+	{
+		return;
+	}
+
+	const TObjectKey<UObject> OwnerKey(Owner);
+	OwnedHandlesInternal.FindOrAdd(OwnerKey).Emplace(Handle);
+	HandleOwnersInternal.Emplace(Handle, OwnerKey);
+
+	// Actors are returned right on destroy, other owners are checked after garbage collection
+	if (AActor* OwnerActor = Cast<AActor>(Owner))
+	{
+		OwnerActor->OnDestroyed.AddUniqueDynamic(this, &ThisClass::OnOwnerDestroyed);
+	}
+}
+
+// Returns all objects of given owner back to their pools in one batch
+int32 UPoolManagerSubsystem::ReturnAllOwnedBy(const UObject* Owner)
+{
+	return Owner ? ReturnOwnedHandles(TObjectKey<UObject>(Owner)) : 0;
+}
+
+// Returns handles of all taken objects of given owner
+void UPoolManagerSubsystem::GetOwnedHandles(const UObject* Owner, TArray<FPoolObjectHandle>& OutHandles) const
+{
+	const TArray<FPoolObjectHandle>* OwnedHandles = Owner ? OwnedHandlesInternal.Find(TObjectKey<UObject>(Owner)) : nullptr;
+	OutHandles = OwnedHandles ? *OwnedHandles : TArray<FPoolObjectHandle>();
+}
+
+// Returns all objects of the owner by its key back to their pools, the owner could be already destroyed
+int32 UPoolManagerSubsystem::ReturnOwnedHandles(const TObjectKey<UObject>& OwnerKey)
+{
+	TArray<FPoolObjectHandle> OwnedHandles;
+	if (!OwnedHandlesInternal.RemoveAndCopyValue(OwnerKey, OwnedHandles))
+	{
+		return 0;
+	}
+
+	if (AActor* OwnerActor = Cast<AActor>(OwnerKey.ResolveObjectPtr()))
+	{
+		OwnerActor->OnDestroyed.RemoveDynamic(this, &ThisClass::OnOwnerDestroyed);
+	}
+
+	// Skip objects that were destroyed by outer code or emptied with their pool
+	OwnedHandles.RemoveAll([this](const FPoolObjectHandle& HandleIt)
+	{
+		HandleOwnersInternal.Remove(HandleIt);
+
+		const FPoolContainer* Pool = FindPool(HandleIt.GetObjectClass());
+		if (!Pool)
+		{
+			return true;
+		}
+
+		if (const FPoolObjectData* ObjectData = Pool->FindInPool(HandleIt))
+		{
+			return !ObjectData->IsActive();
+		}
+
+		// Is still in the spawning queue, so its request is cancelled on return
+		return !Pool->Factory
+			|| !Pool->Factory->GetSpawnQueue().ContainsByPredicate([&HandleIt](const FSpawnRequest& RequestIt) { return RequestIt.Handle == HandleIt; });
+	});
+
+	ReturnToPoolArray(OwnedHandles);
+	return OwnedHandles.Num();
+}
+
+// Unbinds the object from its owner
+void UPoolManagerSubsystem::ReleaseOwner(const FPoolObjectHandle& Handle)
+{
+	TObjectKey<UObject> OwnerKey;
+	if (!HandleOwnersInternal.RemoveAndCopyValue(Handle, OwnerKey))
+	{
+		return;
+	}
+
+	TArray<FPoolObjectHandle>* OwnedHandles = OwnedHandlesInternal.Find(OwnerKey);
+	if (!OwnedHandles)
+	{
+		return;
+	}
+
+	OwnedHandles->RemoveSingleSwap(Handle);
+	if (OwnedHandles->IsEmpty())
+	{
+		OwnedHandlesInternal.Remove(OwnerKey);
+
+		if (AActor* OwnerActor = Cast<AActor>(OwnerKey.ResolveObjectPtr()))
+		{
+			OwnerActor->OnDestroyed.RemoveDynamic(this, &ThisClass::OnOwnerDestroyed);
+		}
+	}
+}
+
+// Is called when any actor that owns pooled objects is destroyed
+void UPoolManagerSubsystem::OnOwnerDestroyed(AActor* DestroyedActor)
+{
+	ReturnAllOwnedBy(DestroyedActor);
+}
+
+// Is called after each garbage collection to return objects of destroyed non-actor owners
+void UPoolManagerSubsystem::OnPostGarbageCollect()
+{
+	TArray<TObjectKey<UObject>> DestroyedOwners;
+	for (const TTuple<TObjectKey<UObject>, TArray<FPoolObjectHandle>>& It : OwnedHandlesInternal)
+	{
+		if (!It.Key.ResolveObjectPtr())
+		{
+			DestroyedOwners.Emplace(It.Key);
+		}
+	}
+
+	for (const TObjectKey<UObject>& OwnerKeyIt : DestroyedOwners)
+	{
+		ReturnOwnedHandles(OwnerKeyIt);
+	}
 }
 
 /*********************************************************************************************
@@ -548,7 +2082,15 @@ void UPoolManagerSubsystem::EmptyPool_Implementation(const UClass* ObjectClass)
 	TArray<FPoolObjectData>& PoolObjects = Pool.PoolObjects;
 	for (int32 Index = PoolObjects.Num() - 1; Index >= 0; --Index)
 	{
-		UObject* ObjectIt = PoolObjects.IsValidIndex(Index) ? PoolObjects[Index].Get() : nullptr;
+		if (!PoolObjects.IsValidIndex(Index))
+		{
+			continue;
+		}
+
+		// Owners are unbound even from invalid objects, so no stale handles are left in the owner registry
+		ReleaseOwner(PoolObjects[Index].Handle);
+
+		UObject* ObjectIt = PoolObjects[Index].Get();
 		if (IsValid(ObjectIt))
 		{
 			Factory.Destroy(ObjectIt);
@@ -556,6 +2098,11 @@ void UPoolManagerSubsystem::EmptyPool_Implementation(const UClass* ObjectClass)
 	}
 
 	PoolObjects.Empty();
+	Pool.ActiveIndices.Empty();
+	Pool.SpatialHash.Reset();
+
+	// Counters of the take history are relative to the totals of the pool, that starts from zero once it is created again
+	TakeHistoryInternal.Remove(ObjectClass);
 
 	PoolsInternal.RemoveAtSwap(PoolIdx);
 }
@@ -571,6 +2118,7 @@ void UPoolManagerSubsystem::EmptyAllPools_Implementation()
 	}
 
 	PoolsInternal.Empty();
+	TakeHistoryInternal.Empty();
 }
 
 // Destroy all objects in Pool Manager based on a predicate functor
@@ -598,10 +2146,21 @@ void UPoolManagerSubsystem::EmptyAllByPredicate(const TFunctionRef<bool(const UO
 				continue;
 			}
 
+			if (PoolIt.SpatialHash.IsEnabled())
+			{
+				if (const AActor* Actor = Cast<AActor>(ObjectIt))
+				{
+					PoolIt.SpatialHash.Remove(*Actor);
+				}
+			}
+
+			ReleaseOwner(PoolObjectsRef[ObjectIndex].Handle);
 			Factory.Destroy(ObjectIt);
 
 			PoolObjectsRef.RemoveAt(ObjectIndex);
 		}
+
+		PoolIt.RebuildActiveIndices();
 	}
 }
 
@@ -736,6 +2295,20 @@ void UPoolManagerSubsystem::Initialize(FSubsystemCollectionBase& Collection)
 
 	InitializeAllFactories();
 
+	// Map is loading, so there is plenty of frame time to fill pools until gameplay begins
+	const UWorld* World = GetWorld();
+	if (World && World->IsGameWorld())
+	{
+		SetSpawnBudgetMode(EPoolSpawnBudgetMode::Loading);
+	}
+
+	AdoptPoolsAfterTravel();
+
+	UPoolManagerSettings::OnPoolBudgetsChanged.AddUObject(this, &ThisClass::OnPoolBudgetsChanged);
+	FCoreUObjectDelegates::GetPostGarbageCollect().AddUObject(this, &ThisClass::OnPostGarbageCollect);
+	FWorldDelegates::LevelAddedToWorld.AddUObject(this, &ThisClass::OnLevelAddedToWorld);
+	FWorldDelegates::LevelRemovedFromWorld.AddUObject(this, &ThisClass::OnLevelRemovedFromWorld);
+
 #if WITH_EDITOR
 	if (GEditor
 		&& !GEditor->IsPlaySessionInProgress() // Is Editor and not in PIE
@@ -767,9 +2340,101 @@ void UPoolManagerSubsystem::Initialize(FSubsystemCollectionBase& Collection)
 // Is called on deinitialization of the Pool Manager instance
 void UPoolManagerSubsystem::Deinitialize()
 {
-	Super::Deinitialize();
+	PendingPredictionsInternal.Empty();
+
+	if (IGameMoviePlayer* MoviePlayer = GetMoviePlayer())
+	{
+		MoviePlayer->OnMoviePlaybackFinished().RemoveAll(this);
+	}
+
+	UPoolManagerSettings::OnPoolBudgetsChanged.RemoveAll(this);
+	FCoreUObjectDelegates::GetPostGarbageCollect().RemoveAll(this);
+	FWorldDelegates::LevelAddedToWorld.RemoveAll(this);
+	FWorldDelegates::LevelRemovedFromWorld.RemoveAll(this);
+	StreamingPoolsInternal.Empty();
+	ShrinkingPoolsInternal.Empty();
+	TakeHistoryInternal.Empty();
+	PendingSpatialActorsInternal.Empty();
+
+	for (const TTuple<TObjectKey<UObject>, TArray<FPoolObjectHandle>>& It : OwnedHandlesInternal)
+	{
+		if (AActor* OwnerActor = Cast<AActor>(It.Key.ResolveObjectPtr()))
+		{
+			OwnerActor->OnDestroyed.RemoveDynamic(this, &ThisClass::OnOwnerDestroyed);
+		}
+	}
+	OwnedHandlesInternal.Empty();
+	HandleOwnersInternal.Empty();
+
+	StashPoolsForTravel();
 
 	ClearAllFactories();
+
+	// Is called last, since pools and factories above still need the subsystem to be initialized
+	Super::Deinitialize();
+}
+
+// Is called when world is ready to start gameplay before the game mode transitions to the correct state and call BeginPlay on all actors
+void UPoolManagerSubsystem::OnWorldBeginPlay(UWorld& InWorld)
+{
+	Super::OnWorldBeginPlay(InWorld);
+
+	// Actors that were kept by seamless travel appear in this world only after its initialization
+	AdoptPoolsAfterTravel();
+
+	// Data layers are available only once World Partition is initialized
+	if (UDataLayerManager* DataLayerManager = UDataLayerManager::GetDataLayerManager(&InWorld))
+	{
+		DataLayerManager->OnDataLayerInstanceRuntimeStateChanged.AddUniqueDynamic(this, &ThisClass::OnDataLayerRuntimeStateChanged);
+	}
+
+	RefreshStreamingPools();
+
+	// Sample only counters that are already collected, so it is cheap enough to be always enabled
+	constexpr float SampleRate = 1.f;
+	constexpr bool bLoop = true;
+	InWorld.GetTimerManager().SetTimer(TakeHistoryTimerInternal, this, &ThisClass::OnSampleTakeHistory, SampleRate, bLoop);
+
+	// Keep the loading budget while loading screen is still shown, so pools are ready at the first playable frame
+	IGameMoviePlayer* MoviePlayer = IsMoviePlayerEnabled() ? GetMoviePlayer() : nullptr;
+	if (MoviePlayer
+		&& MoviePlayer->IsMovieCurrentlyPlaying())
+	{
+		MoviePlayer->OnMoviePlaybackFinished().AddUObject(this, &ThisClass::OnLoadingScreenFinished);
+	}
+	else
+	{
+		// The world does not tick between initialization and begin play, so use the loading budget at least once before the first frame
+		ProcessLoadingSpawnBudget();
+		SetSpawnBudgetMode(EPoolSpawnBudgetMode::Gameplay);
+	}
+}
+
+// Is called once per second to add new sample to the take history of each pool
+void UPoolManagerSubsystem::OnSampleTakeHistory()
+{
+	for (const FPoolContainer& PoolIt : PoolsInternal)
+	{
+		FPoolTakeHistory& History = TakeHistoryInternal.FindOrAdd(PoolIt.ObjectClass);
+		History.AddSample(PoolIt.HitsNum, PoolIt.MissesNum);
+	}
+
+	const float StatsLogInterval = UPoolManagerSettings::Get().GetStatsLogInterval();
+	const double CurrentTime = FPlatformTime::Seconds();
+	if (StatsLogInterval > 0.f
+		&& CurrentTime - LastStatsLogTimeInternal >= StatsLogInterval)
+	{
+		LastStatsLogTimeInternal = CurrentTime;
+		LogPoolStats(*GLog);
+	}
+
+	// Leaks are found by thresholds of seconds, so there is no need to scan more often
+	constexpr double LeakScanInterval = 5.0;
+	if (CurrentTime - LastLeakScanTimeInternal >= LeakScanInterval)
+	{
+		LastLeakScanTimeInternal = CurrentTime;
+		DetectLeaks();
+	}
 }
 
 // Returns the pointer to found pool by specified class
@@ -808,7 +2473,113 @@ void UPoolManagerSubsystem::SetObjectStateInPool(EPoolObjectState NewState, UObj
 		return;
 	}
 
-	PoolObject->bIsActive = NewState == EPoolObjectState::Active;
+	InPool.SetObjectActive(*PoolObject, NewState == EPoolObjectState::Active);
+	ApplyObjectStateInPool(NewState, *PoolObject, InPool);
+
+	if (NewState == EPoolObjectState::Inactive)
+	{
+		// Pool got new free object, so it could exceed the budgets
+		RequestEnforcePoolBudgets();
+	}
+}
+
+// Is the part of SetObjectStateInPool() that does not touch the list of active objects
+void UPoolManagerSubsystem::ApplyObjectStateInPool(EPoolObjectState NewState, FPoolObjectData& InOutData, FPoolContainer& InPool)
+{
+	UObject& InObject = InOutData.GetChecked();
+
+	// Measure how long the object is used from taking to returning
+	if (NewState == EPoolObjectState::Active)
+	{
+		if (InOutData.TakenTime <= 0.0)
+		{
+			InOutData.TakenTime = FPlatformTime::Seconds();
+		}
+
+		if (TakeCallsiteInternal)
+		{
+			InOutData.TakeCallsite = TakeCallsiteInternal;
+		}
+	}
+	else if (InOutData.TakenTime > 0.0)
+	{
+		const double LifetimeSeconds = FPlatformTime::Seconds() - InOutData.TakenTime;
+		InPool.LatencyStats.LifetimeMicroseconds.AddSample(static_cast<uint64>(FMath::Max(LifetimeSeconds, 0.0) * 1000000.0));
+		InOutData.TakenTime = 0.0;
+		InOutData.TakeCallsite = 0;
+		InOutData.bIsLeakReported = false;
+	}
+
+	if (NewState == EPoolObjectState::Inactive)
+	{
+		ReleaseOwner(InOutData.Handle);
+	}
 
+	// Data is not accessed after the callback, since it could take other objects and grow the pool
 	InPool.GetFactoryChecked().OnChangedStateInPool(NewState, &InObject);
+
+	if (InPool.SpatialHash.IsEnabled())
+	{
+		// Taken actor is already moved to its transform by the factory, returned one is not tracked anymore
+		if (AActor* Actor = Cast<AActor>(&InObject))
+		{
+			UpdateSpatialIndex(NewState, *Actor, InPool);
+		}
+	}
+}
+
+// Returns active objects of given pool that match given predicate in one batch
+int32 UPoolManagerSubsystem::ReturnActiveInPool(FPoolContainer& InPool, const TFunctionRef<bool(const UObject* PoolObject)> Predicate)
+{
+	if (InPool.ActiveIndices.IsEmpty())
+	{
+		return 0;
+	}
+
+	// Is copied, since callbacks of returned objects could take or return other objects of this pool
+	const TArray<int32> ActiveIndices = InPool.ActiveIndices;
+	UPoolFactory_UObject& Factory = InPool.GetFactoryChecked();
+	int32 ReturnedNum = 0;
+
+	for (const int32 IndexIt : ActiveIndices)
+	{
+		// Data is found by index each time, since the pool could grow by callbacks
+		UObject* ObjectIt = InPool.PoolObjects.IsValidIndex(IndexIt) ? InPool.PoolObjects[IndexIt].Get() : nullptr;
+		if (!IsValid(ObjectIt)
+			|| !InPool.PoolObjects[IndexIt].IsActive()
+			|| !Predicate(ObjectIt))
+		{
+			continue;
+		}
+
+		const double ReturnStartTime = FPlatformTime::Seconds();
+		Factory.OnReturnToPool(ObjectIt);
+
+		// Only the object is marked as free, the list of active objects is fixed once for the whole batch
+		FPoolObjectData& DataIt = InPool.PoolObjects[IndexIt];
+		DataIt.bIsActive = false;
+		DataIt.ActiveIndex = INDEX_NONE;
+		ApplyObjectStateInPool(EPoolObjectState::Inactive, DataIt, InPool);
+
+		Factory.AddActivationCostSample(InPool.ObjectClass, EPoolObjectState::Inactive, FPlatformTime::Seconds() - ReturnStartTime);
+		++ReturnedNum;
+	}
+
+	if (ReturnedNum == 0)
+	{
+		return 0;
+	}
+
+	if (ReturnedNum == ActiveIndices.Num()
+		&& InPool.ActiveIndices == ActiveIndices)
+	{
+		// All objects are returned and nothing else was taken meanwhile
+		InPool.ActiveIndices.Reset();
+	}
+	else
+	{
+		InPool.RebuildActiveIndices();
+	}
+
+	return ReturnedNum;
 }
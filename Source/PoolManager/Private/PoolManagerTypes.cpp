@@ -2,8 +2,12 @@
 
 #include "PoolManagerTypes.h"
 //---
+#include "GameFramework/Actor.h"
+//---
 #include UE_INLINE_GENERATED_CPP_BY_NAME(PoolManagerTypes)
 
+DEFINE_LOG_CATEGORY(LogPoolManager);
+
 // Empty pool object handle
 const FPoolObjectHandle FPoolObjectHandle::EmptyHandle = FPoolObjectHandle();
 
@@ -90,6 +94,353 @@ EPoolObjectState FPoolObjectData::GetState() const
 	return bIsActive ? EPoolObjectState::Active : EPoolObjectState::Inactive;
 }
 
+// Copies current counters, since atomics can't be copied by default
+FPoolHistogram& FPoolHistogram::operator=(const FPoolHistogram& Other)
+{
+	for (int32 Index = 0; Index < BucketsNum; ++Index)
+	{
+		Buckets[Index].store(Other.GetBucketNum(Index), std::memory_order_relaxed);
+	}
+	return *this;
+}
+
+// Adds the sample to its bucket
+void FPoolHistogram::AddSample(uint64 Value)
+{
+	const int32 BucketIndex = Value > 0 ? FMath::Min(static_cast<int32>(FMath::FloorLog2_64(Value)) + 1, BucketsNum - 1) : 0;
+	Buckets[BucketIndex].fetch_add(1, std::memory_order_relaxed);
+}
+
+// Returns the biggest value that is counted by given bucket
+uint64 FPoolHistogram::GetBucketMaxValue(int32 BucketIndex)
+{
+	if (BucketIndex <= 0)
+	{
+		return 0;
+	}
+
+	return BucketIndex < BucketsNum - 1 ? (1ull << BucketIndex) - 1 : MAX_uint64;
+}
+
+// Returns number of all samples
+int32 FPoolHistogram::GetSamplesNum() const
+{
+	int32 SamplesNum = 0;
+	for (int32 Index = 0; Index < BucketsNum; ++Index)
+	{
+		SamplesNum += GetBucketNum(Index);
+	}
+	return SamplesNum;
+}
+
+// Returns the biggest value of the bucket that contains specified percentile of samples
+uint64 FPoolHistogram::GetPercentile(float Percentile) const
+{
+	const int32 SamplesNum = GetSamplesNum();
+	if (SamplesNum <= 0)
+	{
+		return 0;
+	}
+
+	const int32 TargetNum = FMath::Max(FMath::CeilToInt32(SamplesNum * FMath::Clamp(Percentile, 0.f, 1.f)), 1);
+	int32 CountedNum = 0;
+	for (int32 Index = 0; Index < BucketsNum; ++Index)
+	{
+		CountedNum += GetBucketNum(Index);
+		if (CountedNum >= TargetNum)
+		{
+			return GetBucketMaxValue(Index);
+		}
+	}
+	return GetBucketMaxValue(BucketsNum - 1);
+}
+
+// Removes all samples
+void FPoolHistogram::Reset()
+{
+	for (std::atomic<int32>& BucketIt : Buckets)
+	{
+		BucketIt.store(0, std::memory_order_relaxed);
+	}
+}
+
+// Returns the histogram of given metric
+const FPoolHistogram& FPoolLatencyStats::GetHistogram(EPoolLatencyMetric Metric) const
+{
+	switch (Metric)
+	{
+	case EPoolLatencyMetric::QueueWaitFrames:
+		return QueueWaitFrames;
+	case EPoolLatencyMetric::QueueWaitMs:
+		return QueueWaitMicroseconds;
+	case EPoolLatencyMetric::SpawnMs:
+		return SpawnMicroseconds;
+	default:
+		return LifetimeMicroseconds;
+	}
+}
+
+// Removes all samples of all histograms
+void FPoolLatencyStats::Reset()
+{
+	QueueWaitFrames.Reset();
+	QueueWaitMicroseconds.Reset();
+	SpawnMicroseconds.Reset();
+	LifetimeMicroseconds.Reset();
+}
+
+// Adds given actor or moves it to new location
+void FPoolSpatialHash::Update(const AActor& Actor, const FVector& Location)
+{
+	const TObjectKey<AActor> ActorKey(&Actor);
+	const FIntVector NewCell = GetCell(Location);
+
+	FEntry* Entry = Entries.Find(ActorKey);
+	if (Entry
+		&& Entry->Cell == NewCell)
+	{
+		// Most movements stay within the same cell, so only the location is updated
+		Entry->Location = Location;
+		return;
+	}
+
+	if (Entry)
+	{
+		Remove(Actor);
+	}
+
+	Entries.Emplace(ActorKey, FEntry{Location, NewCell});
+	Cells.FindOrAdd(NewCell).Emplace(ActorKey);
+}
+
+// Removes given actor from the hash
+void FPoolSpatialHash::Remove(const AActor& Actor)
+{
+	const TObjectKey<AActor> ActorKey(&Actor);
+	FEntry Entry;
+	if (!Entries.RemoveAndCopyValue(ActorKey, Entry))
+	{
+		return;
+	}
+
+	TArray<TObjectKey<AActor>>* CellActors = Cells.Find(Entry.Cell);
+	if (!CellActors)
+	{
+		return;
+	}
+
+	CellActors->RemoveSingleSwap(ActorKey);
+	if (CellActors->IsEmpty())
+	{
+		Cells.Remove(Entry.Cell);
+	}
+}
+
+// Removes all actors from the hash
+void FPoolSpatialHash::Reset()
+{
+	Entries.Empty();
+	Cells.Empty();
+}
+
+// Returns all actors within given radius
+void FPoolSpatialHash::FindInRadius(TArray<AActor*>& OutActors, const FVector& Center, float Radius) const
+{
+	if (!OutActors.IsEmpty())
+	{
+		OutActors.Empty();
+	}
+
+	if (!IsEnabled()
+		|| Radius < 0.f)
+	{
+		return;
+	}
+
+	const FIntVector MinCell = GetCell(Center - FVector(Radius));
+	const FIntVector MaxCell = GetCell(Center + FVector(Radius));
+	const double RadiusSquared = FMath::Square(static_cast<double>(Radius));
+
+	auto CollectFromCell = [this, &OutActors, &Center, RadiusSquared](const TArray<TObjectKey<AActor>>& CellActors)
+	{
+		for (const TObjectKey<AActor>& ActorKeyIt : CellActors)
+		{
+			const FEntry& Entry = Entries.FindChecked(ActorKeyIt);
+			AActor* Actor = FVector::DistSquared(Entry.Location, Center) <= RadiusSquared ? ActorKeyIt.ResolveObjectPtr() : nullptr;
+			if (IsValid(Actor))
+			{
+				OutActors.Emplace(Actor);
+			}
+		}
+	};
+
+	// Big radius covers more cells than are occupied, so check occupied cells instead
+	const FIntVector BoxSize = MaxCell - MinCell + FIntVector(1);
+	const int64 BoxCellsNum = static_cast<int64>(BoxSize.X) * BoxSize.Y * BoxSize.Z;
+	if (BoxCellsNum > Cells.Num())
+	{
+		for (const TTuple<FIntVector, TArray<TObjectKey<AActor>>>& CellIt : Cells)
+		{
+			const FIntVector& Cell = CellIt.Key;
+			if (Cell.X >= MinCell.X && Cell.X <= MaxCell.X
+				&& Cell.Y >= MinCell.Y && Cell.Y <= MaxCell.Y
+				&& Cell.Z >= MinCell.Z && Cell.Z <= MaxCell.Z)
+			{
+				CollectFromCell(CellIt.Value);
+			}
+		}
+		return;
+	}
+
+	for (int32 X = MinCell.X; X <= MaxCell.X; ++X)
+	{
+		for (int32 Y = MinCell.Y; Y <= MaxCell.Y; ++Y)
+		{
+			for (int32 Z = MinCell.Z; Z <= MaxCell.Z; ++Z)
+			{
+				if (const TArray<TObjectKey<AActor>>* CellActors = Cells.Find(FIntVector(X, Y, Z)))
+				{
+					CollectFromCell(*CellActors);
+				}
+			}
+		}
+	}
+}
+
+// Returns up to specified number of actors that are nearest to given location
+void FPoolSpatialHash::FindNearest(TArray<AActor*>& OutActors, const FVector& Location, int32 MaxNum) const
+{
+	if (!OutActors.IsEmpty())
+	{
+		OutActors.Empty();
+	}
+
+	if (!IsEnabled()
+		|| MaxNum <= 0
+		|| Entries.IsEmpty())
+	{
+		return;
+	}
+
+	TArray<TPair<double, TObjectKey<AActor>>> FoundActors;
+	auto CollectFromCell = [this, &FoundActors, &Location](const TArray<TObjectKey<AActor>>& CellActors)
+	{
+		for (const TObjectKey<AActor>& ActorKeyIt : CellActors)
+		{
+			FoundActors.Emplace(FVector::DistSquared(Entries.FindChecked(ActorKeyIt).Location, Location), ActorKeyIt);
+		}
+	};
+
+	// Visit shells of cells around the location from the nearest one
+	const FIntVector CenterCell = GetCell(Location);
+	int32 VisitedNum = 0;
+	for (int32 Ring = 0; VisitedNum < Entries.Num(); ++Ring)
+	{
+		const int64 ShellCellsNum = Ring > 0 ? FMath::Cube(2ll * Ring + 1) - FMath::Cube(2ll * Ring - 1) : 1;
+		if (ShellCellsNum > Cells.Num())
+		{
+			// Remaining actors are sparse, so it's cheaper to check all cells that are not visited yet
+			for (const TTuple<FIntVector, TArray<TObjectKey<AActor>>>& CellIt : Cells)
+			{
+				const FIntVector Offset = CellIt.Key - CenterCell;
+				if (FMath::Max3(FMath::Abs(Offset.X), FMath::Abs(Offset.Y), FMath::Abs(Offset.Z)) >= Ring)
+				{
+					CollectFromCell(CellIt.Value);
+				}
+			}
+			break;
+		}
+
+		for (int32 X = -Ring; X <= Ring; ++X)
+		{
+			for (int32 Y = -Ring; Y <= Ring; ++Y)
+			{
+				// Inner cells of the shell are already visited, so only its faces are left
+				const bool bIsOnSide = FMath::Abs(X) == Ring || FMath::Abs(Y) == Ring;
+				for (int32 Z = -Ring; Z <= Ring; Z += bIsOnSide ? 1 : FMath::Max(2 * Ring, 1))
+				{
+					if (const TArray<TObjectKey<AActor>>* CellActors = Cells.Find(CenterCell + FIntVector(X, Y, Z)))
+					{
+						CollectFromCell(*CellActors);
+						VisitedNum += CellActors->Num();
+					}
+				}
+			}
+		}
+
+		// Actors of next shells are at least this far, so stop once enough nearer ones are found
+		if (FoundActors.Num() >= MaxNum)
+		{
+			FoundActors.Sort([](const TPair<double, TObjectKey<AActor>>& A, const TPair<double, TObjectKey<AActor>>& B) { return A.Key < B.Key; });
+			if (FoundActors[MaxNum - 1].Key <= FMath::Square(static_cast<double>(Ring) * CellSize))
+			{
+				break;
+			}
+		}
+	}
+
+	FoundActors.Sort([](const TPair<double, TObjectKey<AActor>>& A, const TPair<double, TObjectKey<AActor>>& B) { return A.Key < B.Key; });
+	for (const TPair<double, TObjectKey<AActor>>& FoundIt : FoundActors)
+	{
+		AActor* Actor = FoundIt.Value.ResolveObjectPtr();
+		if (IsValid(Actor))
+		{
+			OutActors.Emplace(Actor);
+			if (OutActors.Num() >= MaxNum)
+			{
+				break;
+			}
+		}
+	}
+}
+
+// Returns the actor that is farthest from given location
+AActor* FPoolSpatialHash::FindFarthest(const FVector& Location) const
+{
+	AActor* FarthestActor = nullptr;
+	double FarthestDistSquared = -1.0;
+	for (const TTuple<FIntVector, TArray<TObjectKey<AActor>>>& CellIt : Cells)
+	{
+		// Skip cells whose farthest corner is nearer than already found actor
+		const FVector CellMin = FVector(CellIt.Key) * CellSize;
+		const FVector CellMax = CellMin + FVector(CellSize);
+		const FVector FarthestCorner(FMath::Max(FMath::Abs(Location.X - CellMin.X), FMath::Abs(Location.X - CellMax.X)),
+		                             FMath::Max(FMath::Abs(Location.Y - CellMin.Y), FMath::Abs(Location.Y - CellMax.Y)),
+		                             FMath::Max(FMath::Abs(Location.Z - CellMin.Z), FMath::Abs(Location.Z - CellMax.Z)));
+		if (FarthestCorner.SizeSquared() <= FarthestDistSquared)
+		{
+			continue;
+		}
+
+		for (const TObjectKey<AActor>& ActorKeyIt : CellIt.Value)
+		{
+			const double DistSquared = FVector::DistSquared(Entries.FindChecked(ActorKeyIt).Location, Location);
+			if (DistSquared <= FarthestDistSquared)
+			{
+				continue;
+			}
+
+			AActor* Actor = ActorKeyIt.ResolveObjectPtr();
+			if (IsValid(Actor))
+			{
+				FarthestActor = Actor;
+				FarthestDistSquared = DistSquared;
+			}
+		}
+	}
+
+	return FarthestActor;
+}
+
+// Returns the cell that contains given location
+FIntVector FPoolSpatialHash::GetCell(const FVector& Location) const
+{
+	checkf(IsEnabled(), TEXT("ERROR: [%i] %hs:\n'CellSize' is not set!"), __LINE__, __FUNCTION__);
+	return FIntVector(FMath::FloorToInt32(Location.X / CellSize),
+	                  FMath::FloorToInt32(Location.Y / CellSize),
+	                  FMath::FloorToInt32(Location.Z / CellSize));
+}
+
 // Parameterized constructor that takes a class of the pool
 FPoolContainer::FPoolContainer(const UClass* InClass)
 {
@@ -120,6 +471,60 @@ UPoolFactory_UObject& FPoolContainer::GetFactoryChecked() const
 	return *Factory;
 }
 
+// Marks given object of this pool as active or free and updates the list of active objects
+void FPoolContainer::SetObjectActive(FPoolObjectData& InOutData, bool bNewActive)
+{
+	const int32 Index = static_cast<int32>(&InOutData - PoolObjects.GetData());
+	if (!ensureMsgf(PoolObjects.IsValidIndex(Index), TEXT("ASSERT: [%i] %hs:\n'InOutData' is not contained in the pool of '%s' class!"), __LINE__, __FUNCTION__, *GetNameSafe(ObjectClass)))
+	{
+		return;
+	}
+
+	InOutData.bIsActive = bNewActive;
+
+	const bool bIsListed = ActiveIndices.IsValidIndex(InOutData.ActiveIndex)
+		&& ActiveIndices[InOutData.ActiveIndex] == Index;
+	if (bNewActive)
+	{
+		// Registered object can be already active
+		if (!bIsListed)
+		{
+			InOutData.ActiveIndex = ActiveIndices.Emplace(Index);
+		}
+	}
+	else if (bIsListed)
+	{
+		// Order does not matter, so the last one is moved in place of removed one
+		const int32 RemovedAt = InOutData.ActiveIndex;
+		const int32 LastObjectIndex = ActiveIndices.Last();
+		ActiveIndices.RemoveAtSwap(RemovedAt, EAllowShrinking::No);
+		if (RemovedAt < ActiveIndices.Num())
+		{
+			PoolObjects[LastObjectIndex].ActiveIndex = RemovedAt;
+		}
+		InOutData.ActiveIndex = INDEX_NONE;
+	}
+}
+
+// Rebuilds the list of active objects, is called after objects are removed from the pool
+void FPoolContainer::RebuildActiveIndices()
+{
+	ActiveIndices.Reset();
+	for (int32 Index = 0; Index < PoolObjects.Num(); ++Index)
+	{
+		FPoolObjectData& DataIt = PoolObjects[Index];
+		DataIt.ActiveIndex = DataIt.bIsActive ? ActiveIndices.Emplace(Index) : INDEX_NONE;
+	}
+}
+
+// Adds measured time to given moving estimate
+void FPoolSpawnCost::AddSample(float& InOutEstimateMs, int32& InOutSamplesNum, double Seconds)
+{
+	const float SampleMs = static_cast<float>(FMath::Max(Seconds, 0.0) * 1000.0);
+	InOutEstimateMs = InOutSamplesNum > 0 ? FMath::Lerp(InOutEstimateMs, SampleMs, SmoothingFactor) : SampleMs;
+	++InOutSamplesNum;
+}
+
 // Parameterized constructor that takes class of the object to spawn, generates handle automatically
 FSpawnRequest::FSpawnRequest(const UClass* InClass)
 	: Handle(InClass) {}
@@ -140,6 +545,31 @@ void FSpawnRequest::MakeRequests(TArray<FSpawnRequest>& OutRequests, const UClas
 	}
 }
 
+// Adds new second to the history by current total hits and misses of the pool
+void FPoolTakeHistory::AddSample(int32 HitsNum, int32 MissesNum)
+{
+	// Totals could be reset since last sample, e.g: by recreating the pool, so counts are never negative
+	const int32 NewMissesNum = FMath::Max(MissesNum - LastMissesNum, 0);
+	TakesPerSecond[NextIndex] = FMath::Max(HitsNum - LastHitsNum, 0) + NewMissesNum;
+	MissesPerSecond[NextIndex] = NewMissesNum;
+	NextIndex = (NextIndex + 1) % SecondsNum;
+
+	LastHitsNum = HitsNum;
+	LastMissesNum = MissesNum;
+}
+
+// Returns number of misses during specified last seconds
+int32 FPoolTakeHistory::GetMissesNum(int32 LastSecondsNum) const
+{
+	int32 Result = 0;
+	const int32 Num = FMath::Clamp(LastSecondsNum, 0, SecondsNum);
+	for (int32 Index = 1; Index <= Num; ++Index)
+	{
+		Result += MissesPerSecond[(NextIndex - Index + SecondsNum) % SecondsNum];
+	}
+	return Result;
+}
+
 // Leave only those requests that are not in the list of free objects
 void FSpawnRequest::FilterRequests(TArray<FSpawnRequest>& InOutRequests, const TArray<FPoolObjectData>& FreeObjectsData, int32 ExpectedAmount/* = INDEX_NONE*/)
 {
@@ -0,0 +1,52 @@
+﻿// Copyright (c) Yevhenii Selivanov
+
+#pragma once
+
+#include "GameFramework/Actor.h"
+//---
+#include "PoolPrebakedActors.generated.h"
+
+/**
+ * Contains inactive pooled actors that are generated in the editor and saved and cooked with the level.
+ * Place it on the level, set the class and amount, then press 'Generate Baked Actors' in its details.
+ * On BeginPlay, all baked actors are registered in the Pool Manager at once, so the pool is full with no runtime spawn cost.
+ */
+UCLASS(NotBlueprintable, HideCategories = ("Rendering", "Physics", "Collision", "Input", "HLOD", "Actor Tick"))
+class POOLMANAGER_API APoolPrebakedActors : public AActor
+{
+	GENERATED_BODY()
+
+public:
+	/** Default constructor. */
+	APoolPrebakedActors();
+
+	/** Returns all actors that are baked into the level. */
+	UFUNCTION(BlueprintPure, Category = "Pool Manager")
+	const FORCEINLINE TArray<AActor*>& GetBakedActors() const { return BakedActorsInternal; }
+
+#if WITH_EDITOR
+	/** Destroys previously baked actors and spawns new inactive ones of specified class and amount into the level of this actor. */
+	UFUNCTION(CallInEditor, Category = "Pool Manager")
+	void GenerateBakedActors();
+
+	/** Destroys all baked actors. */
+	UFUNCTION(CallInEditor, Category = "Pool Manager")
+	void ClearBakedActors();
+#endif // WITH_EDITOR
+
+protected:
+	/** Class of actors to bake into the level. */
+	UPROPERTY(EditInstanceOnly, BlueprintReadOnly, Category = "Pool Manager", meta = (BlueprintProtected, DisplayName = "Actor Class"))
+	TSubclassOf<AActor> ActorClassInternal = nullptr;
+
+	/** Amount of actors to bake into the level. */
+	UPROPERTY(EditInstanceOnly, BlueprintReadOnly, Category = "Pool Manager", meta = (BlueprintProtected, DisplayName = "Amount", ClampMin = "0"))
+	int32 AmountInternal = 10;
+
+	/** Actors that are baked into the level, are registered in the Pool Manager on BeginPlay. */
+	UPROPERTY(VisibleInstanceOnly, BlueprintReadOnly, Category = "Pool Manager", meta = (BlueprintProtected, DisplayName = "Baked Actors"))
+	TArray<TObjectPtr<AActor>> BakedActorsInternal;
+
+	/** Is overridden to register all baked actors in the Pool Manager. */
+	virtual void BeginPlay() override;
+};
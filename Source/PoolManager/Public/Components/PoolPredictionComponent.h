@@ -0,0 +1,44 @@
+﻿// Copyright (c) Yevhenii Selivanov
+
+#pragma once
+
+#include "Components/ActorComponent.h"
+//---
+#include "PoolPredictionComponent.generated.h"
+
+/**
+ * Links the server's authoritative pooled actor with the client's predicted stand-in.
+ * Add this component to the pooled actor class (e.g. projectile) that is taken by prediction:
+ * - Client calls UPoolManagerSubsystem::TakePredictedFromPool() and sends returned Prediction Id to the server by own RPC.
+ * - Server calls UPoolManagerSubsystem::TakeFromPoolForPrediction() with the same id, it is replicated by this component.
+ * - Once the authoritative actor becomes relevant, the client reconciles it and returns its stand-in to the pool.
+ */
+UCLASS(ClassGroup = (PoolManager), meta = (BlueprintSpawnableComponent))
+class POOLMANAGER_API UPoolPredictionComponent : public UActorComponent
+{
+	GENERATED_BODY()
+
+public:
+	/** Default constructor. */
+	UPoolPredictionComponent();
+
+	/** Returns the id shared with the client's stand-in, is invalid if the owner was not taken by prediction. */
+	UFUNCTION(BlueprintPure, Category = "Pool Manager")
+	const FORCEINLINE FGuid& GetPredictionId() const { return PredictionIdInternal; }
+
+	/** Is called on the server to set the id of the client's stand-in that predicts the owner. */
+	UFUNCTION(BlueprintCallable, BlueprintAuthorityOnly, Category = "Pool Manager")
+	void SetPredictionId(const FGuid& NewPredictionId);
+
+protected:
+	/** The id shared with the client's stand-in, is derived from the stand-in's handle. */
+	UPROPERTY(VisibleInstanceOnly, BlueprintReadOnly, Transient, ReplicatedUsing = "OnRep_PredictionId", Category = "Pool Manager", meta = (BlueprintProtected, DisplayName = "Prediction Id"))
+	FGuid PredictionIdInternal;
+
+	/** Is called on client when the authoritative owner with new prediction id becomes relevant. */
+	UFUNCTION()
+	void OnRep_PredictionId();
+
+	/** Returns properties that are replicated for the lifetime of the actor channel. */
+	virtual void GetLifetimeReplicatedProps(TArray<FLifetimeProperty>& OutLifetimeProps) const override;
+};
@@ -11,6 +11,8 @@ class UPoolFactory_UObject;
 /**
  * Contains common settings data of the Pool Manager plugin.
  * Is set up in 'Project Settings' -> "Plugins" -> "Pool Manager".
+ * Budgets can be overridden per platform by 'PoolManager.*' console variables,
+ * e.g: in device profiles as '+CVars=PoolManager.SpawnObjectsPerFrame=2' or in scalability groups.
  */
 UCLASS(Config = "PoolManager", DefaultConfig, meta = (DisplayName = "Pool Manager"))
 class POOLMANAGER_API UPoolManagerSettings : public UDeveloperSettings
@@ -31,20 +33,89 @@ public:
 	/** Gets the category for the settings, some high level grouping like, Editor, Engine, Game...etc. */
 	virtual FName GetCategoryName() const override { return TEXT("Plugins"); }
 
-	/** Returns a limit of how many actors to spawn per frame. */
+	/** Is broadcasted when any pool budget is changed by console variable, e.g: by device profile or scalability group. */
+	static FSimpleMulticastDelegate OnPoolBudgetsChanged;
+
+	/** Returns a limit of how many actors to spawn per frame.
+	 * Is overridden by 'PoolManager.SpawnObjectsPerFrame' console variable. */
+	UFUNCTION(BlueprintPure, Category = "Pool Manager")
+	int32 GetSpawnObjectsPerFrame() const;
+
+	/** Returns a limit of how many actors to spawn per frame while the map is loading.
+	 * Is overridden by 'PoolManager.LoadingSpawnObjectsPerFrame' console variable. */
+	UFUNCTION(BlueprintPure, Category = "Pool Manager")
+	int32 GetLoadingSpawnObjectsPerFrame() const;
+
+	/** Returns milliseconds of the game thread that spawning can take per frame during gameplay, 0 means only objects count is limited.
+	 * Is overridden by 'PoolManager.SpawnBudgetMs' console variable. */
+	UFUNCTION(BlueprintPure, Category = "Pool Manager")
+	float GetSpawnBudgetMs() const;
+
+	/** Returns the maximum number of free objects each pool can keep, -1 means unlimited.
+	 * Is set by 'PoolManager.MaxFreeObjectsPerPool' console variable. */
+	UFUNCTION(BlueprintPure, Category = "Pool Manager")
+	int32 GetMaxFreeObjectsPerPool() const;
+
+	/** Returns the multiplier of all pre-warmed amounts, e.g: less than 1 on low-end devices.
+	 * Is set by 'PoolManager.PrewarmMultiplier' console variable. */
+	UFUNCTION(BlueprintPure, Category = "Pool Manager")
+	float GetPrewarmMultiplier() const;
+
+	/** Returns estimated memory in megabytes that free objects of all pools can take, 0 means unlimited.
+	 * Is set by 'PoolManager.MemoryBudgetMB' console variable. */
+	UFUNCTION(BlueprintPure, Category = "Pool Manager")
+	float GetMemoryBudgetMB() const;
+
+	/** Returns how often in seconds the summary of pool stats is printed to the log, 0 means never.
+	 * Is set by 'PoolManager.StatsLogInterval' console variable. */
+	UFUNCTION(BlueprintPure, Category = "Pool Manager")
+	float GetStatsLogInterval() const;
+
+	/** Returns default seconds after which active object is reported as leaked if it's never returned, 0 means never.
+	 * Is set by 'PoolManager.LeakThresholdSeconds' console variable, can be overridden per class by UPoolManagerSubsystem::SetLeakThreshold(). */
 	UFUNCTION(BlueprintPure, Category = "Pool Manager")
-	int32 GetSpawnObjectsPerFrame() const { return SpawnObjectsPerFrame; }
+	float GetLeakThresholdSeconds() const;
 
 	/** Returns all Pool Factories that will be used by the Pool Manager. */
 	UFUNCTION(BlueprintPure, Category = "Pool Manager")
 	void GetPoolFactories(TArray<UClass*>& OutBlueprintPoolFactories) const;
 
+	/** Returns true if free pooled objects are kept by the game instance through seamless travel and level transitions. */
+	UFUNCTION(BlueprintPure, Category = "Pool Manager")
+	bool ShouldPersistPoolsAcrossTravel() const { return bPersistPoolsAcrossTravel; }
+
+	/** Returns how long the client keeps predicted stand-in until the server confirms it. */
+	UFUNCTION(BlueprintPure, Category = "Pool Manager")
+	float GetPredictionTimeout() const { return PredictionTimeout; }
+
 protected:
 	/** Set a limit of how many actors to spawn per frame. */
 	UPROPERTY(Config, EditDefaultsOnly, BlueprintReadOnly, Category = "Pool Manager", meta = (BlueprintProtected = "true"))
 	int32 SpawnObjectsPerFrame;
 
+	/** Set a limit of how many actors to spawn per frame while the map is loading or loading screen is shown.
+	 * Is usually much bigger than 'Spawn Objects Per Frame' since frame time is not important during loading.
+	 * The world does not tick while its map is loading, so with no loading screen movie, it is applied only once when the world begins play. */
+	UPROPERTY(Config, EditDefaultsOnly, BlueprintReadOnly, Category = "Pool Manager", meta = (BlueprintProtected = "true", ClampMin = "1"))
+	int32 LoadingSpawnObjectsPerFrame;
+
+	/** Set milliseconds of the game thread that spawning can take per frame during gameplay, 0 means only 'Spawn Objects Per Frame' is used.
+	 * Spawns are packed into the frame by measured cost of their classes, but at least one object is spawned per frame. */
+	UPROPERTY(Config, EditDefaultsOnly, BlueprintReadOnly, Category = "Pool Manager", meta = (BlueprintProtected = "true", ClampMin = "0", Units = "Milliseconds"))
+	float SpawnBudgetMs;
+
 	/** All Pool Factories that will be used by the Pool Manager. */
 	UPROPERTY(Config, EditDefaultsOnly, BlueprintReadOnly, Category = "Pool Manager", meta = (BlueprintProtected = "true"))
 	TArray<TSoftClassPtr<UPoolFactory_UObject>> PoolFactories;
+
+	/** If true, free pooled objects are kept by the game instance on destroying the world and are adopted by the next world's Pool Manager.
+	 * UObjects and Widgets are always kept, actors are kept only if they are added to the game mode's seamless travel list.
+	 * @see UPoolManagerSubsystem::GetSeamlessTravelActors(). */
+	UPROPERTY(Config, EditDefaultsOnly, BlueprintReadOnly, Category = "Pool Manager", meta = (BlueprintProtected = "true"))
+	bool bPersistPoolsAcrossTravel;
+
+	/** Set how long in seconds the client keeps predicted stand-in until the server confirms it, then stand-in is returned to the pool.
+	 * 0 means the stand-in is kept until prediction is reconciled or cancelled manually. */
+	UPROPERTY(Config, EditDefaultsOnly, BlueprintReadOnly, Category = "Pool Manager", meta = (BlueprintProtected = "true", ClampMin = "0", Units = "Seconds"))
+	float PredictionTimeout;
 };
@@ -4,13 +4,25 @@
 
 #include "PoolFactory_UObject.h"
 //---
+#include "Engine/TimerHandle.h"
+//---
 #include "PoolFactory_Actor.generated.h"
 
+class FTimerManager;
+class UInstancedStaticMeshComponent;
+class USceneComponent;
+class USkeletalMeshComponent;
+class UStaticMeshComponent;
+enum class EUpdateTransformFlags : int32;
+enum class ETeleportType : uint8;
+
 /**
  * Is responsible for managing actors, it handles such differences in actors as:
  * Creation: call SpawnActor.  
  * Destruction: call DestroyActor.
- * Pool: change visibility, collision, ticking, etc.
+ * Pool: change visibility, collision, ticking of actor and its components, network dormancy etc.
+ * Compound: optionally, attached actors owned by pooled actor are pooled together with it as one pool entry.
+ * Instanced Proxy: optionally, taken actors of simple classes are rendered as instances of one pool-owned instanced mesh.
  */
 UCLASS()
 class POOLMANAGER_API UPoolFactory_Actor : public UPoolFactory_UObject
@@ -45,12 +57,306 @@ public:
 	 * Pool
 	 ********************************************************************************************* */
 public:
-	/** Is overridden to set transform to the actor before taking the object from its pool. */
-	virtual void OnTakeFromPool_Implementation(UObject* Object, const FTransform& Transform) override;
+	/** Is overridden to set transform and reset components of the actor before taking the object from its pool.
+	 * Both are done before the object's callback is called, so it could override the reset state. */
+	virtual void OnTakeFromPool_Implementation(UObject* Object, const FTransform& Transform, const FInstancedStruct& Payload) override;
+
+	/** Keeps the deprecated signature with no payload visible, so it's not hidden by the override above. */
+	PRAGMA_DISABLE_DEPRECATION_WARNINGS
+	using Super::OnTakeFromPool_Implementation;
+	PRAGMA_ENABLE_DEPRECATION_WARNINGS
 
 	/** Is overridden to reset transform to the actor before returning the object to its pool. */
 	virtual void OnReturnToPool_Implementation(UObject* Object) override;
 
 	/** Is overridden to change visibility, collision, ticking, etc. according new state. */
 	virtual void OnChangedStateInPool_Implementation(EPoolObjectState NewState, UObject* InObject) override;
+
+	/** Is overridden to keep only actors that were moved out of destroying world by seamless travel. */
+	virtual bool CanPersistAcrossTravel_Implementation(const UObject* Object) const override;
+
+	/** Is overridden to include memory of all components of the actor. */
+	virtual int64 EstimateObjectSize_Implementation(const UObject* Object) const override;
+
+	/*********************************************************************************************
+	 * Compound
+	 * Attached actors, e.g: weapons or actors of child actor components, are pooled together with their root actor.
+	 ********************************************************************************************* */
+public:
+	/** Returns actors that are pooled together with given root actor, is empty if 'Pool Attached Actors' is disabled. */
+	UFUNCTION(BlueprintCallable, Category = "Pool Factory")
+	void GetCompoundChildren(const AActor* RootActor, TArray<AActor*>& OutChildren) const;
+
+protected:
+	/** If true, attached actors that belong to pooled actor are taken, returned and destroyed together with it in one pass,
+	 * so children spawned by child actor components or on BeginPlay are never respawned on reuse.
+	 * Only actors owned by the root or created by child actor components of the root (or of its included children) are included,
+	 * so unrelated actors attached at the moment, e.g: player standing on pooled platform, are never touched.
+	 * Attached actors that are registered in the Pool Manager by their own are not included. */
+	UPROPERTY(EditDefaultsOnly, BlueprintReadWrite, Category = "Pool Factory", meta = (BlueprintProtected))
+	bool bPoolAttachedActors = false;
+
+	/** Attached actors by their pooled root actors. */
+	TMap<TObjectKey<AActor>, TArray<TWeakObjectPtr<AActor>>> CompoundChildrenInternal;
+
+	/** Collects attached actors of given root actor to be pooled together with it.
+	 * Is called once spawning is finished and on each return, so children that were attached while active are pooled too. */
+	virtual void RefreshCompoundChildren(AActor& RootActor);
+
+	/** Changes visibility, collision, ticking and dormancy of given actor according to new state.
+	 * Is applied to the root actor and all its compound children. */
+	virtual void SetActorStateInPool(AActor& Actor, bool bActivate);
+
+	/*********************************************************************************************
+	 * Tick Suspension
+	 * Free actors in the pool do not tick at all, including their components, timers and latent actions.
+	 ********************************************************************************************* */
+protected:
+	/** Tick functions that were enabled before returning to the pool, only they are enabled back on taking. */
+	struct FPoolTickState
+	{
+		bool bWasActorTickEnabled = false;
+		TArray<TWeakObjectPtr<UActorComponent>> TickingComponents;
+
+		/** Timers that were running before returning to the pool, only they are unpaused on taking. */
+		TArray<FTimerHandle> PausedTimers;
+	};
+
+	/** If true, pending timers and latent actions of returned actors and their components are cleared instead of pausing timers.
+	 * By default, timers are paused and unpaused on take, but the engine can't list timers per object,
+	 * so only timers whose handles are stored in properties of the actor and its components are found, e.g: Blueprint 'Timer Handle' variables.
+	 * Enable it if such actors set timers with no stored handles, keep in mind BeginPlay is called only once,
+	 * so looping timers set there would never run again after the first return. */
+	UPROPERTY(EditDefaultsOnly, BlueprintReadWrite, Category = "Pool Factory", meta = (BlueprintProtected))
+	bool bClearTimersInPool = false;
+
+	/** Tick states of actors in the pool. */
+	TMap<TObjectKey<AActor>, FPoolTickState> TickStatesInternal;
+
+	/** Timer handle properties by classes, are collected once per class, so properties are not looked through on each return. */
+	TMap<TObjectKey<UClass>, TArray<const FStructProperty*>> TimerPropertiesInternal;
+
+	/** Pauses running timers of given object whose handles are stored in its properties.
+	 * @param Object The actor or component to pause timers of.
+	 * @param TimerManager The timer manager of the object's world.
+	 * @param OutPausedTimers Paused timers are added here, so they are unpaused on take. */
+	virtual void PauseTimersInPool(UObject& Object, FTimerManager& TimerManager, TArray<FTimerHandle>& OutPausedTimers);
+
+	/** Suspends tick functions of given actor and all its components, or enables back exactly those that were ticking. */
+	virtual void SetTickStateInPool(AActor& Actor, bool bActivate);
+
+	/*********************************************************************************************
+	 * Navigation
+	 * Free actors in the pool do not affect navigation, so recycling them does not rebuild the navmesh at the parking location.
+	 ********************************************************************************************* */
+protected:
+	/** If true, components of returned actors are removed from navigation before moving them away,
+	 * and are added back on taking right after the actor is moved to its new location.
+	 * Is opt-in, since taken actors are added to navigation again at their new location, so the navmesh is rebuilt there. */
+	UPROPERTY(EditDefaultsOnly, BlueprintReadWrite, Category = "Pool Factory", meta = (BlueprintProtected))
+	bool bNavigationNeutralInPool = false;
+
+	/** Components that were removed from navigation while their actors are in the pool. */
+	TMap<TObjectKey<AActor>, TArray<TWeakObjectPtr<UActorComponent>>> NavigationComponentsInternal;
+
+	/** Removes components of given actor from navigation or adds them back. */
+	virtual void SetNavigationStateInPool(AActor& Actor, bool bActivate);
+
+	/*********************************************************************************************
+	 * Component Reset
+	 * Components of specific classes, e.g: projectile movement, audio or effects, are reset by registered handlers on take and return.
+	 ********************************************************************************************* */
+public:
+	/** Resets given component on taking from the pool if bActivate is true, or on returning to the pool otherwise. */
+	using FComponentResetHandler = TFunction<void(UActorComponent& /*Component*/, bool /*bActivate*/)>;
+
+	/** Adds the handler that resets all components of given class and its children of pooled actors.
+	 * Could be called by any module on its startup, built-in handlers for common engine components are registered by default. */
+	static void RegisterComponentResetHandler(TSubclassOf<UActorComponent> ComponentClass, FComponentResetHandler Handler);
+
+	/** Removes all handlers registered exactly for given component class, e.g: to replace built-in handler by own one. */
+	static void UnregisterComponentResetHandlers(TSubclassOf<UActorComponent> ComponentClass);
+
+protected:
+	/** Registered handler with the component class it is applied to. */
+	struct FComponentResetHandlerEntry
+	{
+		TSubclassOf<UActorComponent> ComponentClass = nullptr;
+		FComponentResetHandler Handler = nullptr;
+	};
+
+	/** Component of pooled actor with the index of registered handler that is applied to it. */
+	struct FComponentResetBinding
+	{
+		TWeakObjectPtr<UActorComponent> Component = nullptr;
+		int32 HandlerIndex = INDEX_NONE;
+	};
+
+	/** If true, components of pooled actors are reset by registered handlers on each take and return. */
+	UPROPERTY(EditDefaultsOnly, BlueprintReadWrite, Category = "Pool Factory", meta = (BlueprintProtected))
+	bool bResetComponentsInPool = true;
+
+	/** Indices of registered handlers that are applied to actors of each class, are collected once per actor class. */
+	TMap<TObjectKey<UClass>, TArray<int32>> ComponentResetHandlersByClassInternal;
+
+	/** Components of each pooled actor paired with handlers applied to them, are collected once on first state change of the actor,
+	 * so takes and returns do not iterate components at all. Components added to the actor later are not reset. */
+	TMap<TObjectKey<AActor>, TArray<FComponentResetBinding>> ComponentResetBindingsInternal;
+
+	/** Version of registered handlers that were cached by this factory, the caches are collected again once any handler is (un)registered. */
+	uint32 ComponentResetHandlersVersionInternal = 0;
+
+	/** Returns all registered handlers, built-in ones are registered on first call. */
+	static TArray<FComponentResetHandlerEntry>& GetComponentResetHandlers();
+
+	/** Returns the version that is increased on each change of registered handlers. */
+	static uint32& GetComponentResetHandlersVersion();
+
+	/** Returns cached indices of registered handlers that are applied to components of given actor class. */
+	const TArray<int32>& GetComponentResetHandlersForActor(const AActor& Actor);
+
+	/** Returns cached components of given actor paired with registered handlers that are applied to them. */
+	const TArray<FComponentResetBinding>& GetComponentResetBindings(const AActor& Actor);
+
+	/** Applies registered handlers to all components of given actor.
+	 * Is called on take before the object's callback, and on return together with other states of the actor. */
+	virtual void ResetComponentsInPool(AActor& Actor, bool bActivate);
+
+	/** Built-in handlers for common engine components. */
+	static void ResetProjectileMovement(UActorComponent& Component, bool bActivate);
+	static void ResetAudio(UActorComponent& Component, bool bActivate);
+	static void ResetEffect(UActorComponent& Component, bool bActivate);
+	static void ResetDecal(UActorComponent& Component, bool bActivate);
+	static void ResetPhysics(UActorComponent& Component, bool bActivate);
+
+	/*********************************************************************************************
+	 * Skeletal Meshes
+	 * Animation instances are kept warm while actors are in the pool, so they are not initialized again on reuse.
+	 ********************************************************************************************* */
+protected:
+	/** State of skeletal mesh that was changed on returning to the pool, is restored on taking. */
+	struct FPoolSkeletalMeshState
+	{
+		bool bWasTickEnabled = false;
+		bool bWasAnimPaused = false;
+		bool bWasSkeletonUpdateDisabled = false;
+	};
+
+	/** If true, skeletal meshes of returned actors stop evaluating animation, bone updates and cloth, but keep their animation instances,
+	 * so on taking, their pose and animation state are restored with no expensive initialization of animation instances. */
+	UPROPERTY(EditDefaultsOnly, BlueprintReadWrite, Category = "Pool Factory", meta = (BlueprintProtected))
+	bool bKeepAnimationWarmInPool = true;
+
+	/** States of skeletal meshes of actors in the pool. */
+	TMap<TObjectKey<USkeletalMeshComponent>, FPoolSkeletalMeshState> SkeletalMeshStatesInternal;
+
+	/** Pauses or resumes animation, bone updates and cloth of all skeletal meshes of given actor. */
+	virtual void SetSkeletalMeshesStateInPool(AActor& Actor, bool bActivate);
+
+	/*********************************************************************************************
+	 * Instanced Proxy
+	 * Is opt-in mode for visually simple actors with one static mesh, e.g: shell casings, debris or pickups.
+	 * Their own static mesh is hidden, so it has no scene proxy, while the actor is rendered as instance of one instanced mesh per class.
+	 * Collision and logic of actors are kept as is, so the actor has to be promoted only if its visuals are changed by gameplay.
+	 ********************************************************************************************* */
+public:
+	/** Starts rendering taken actors of given class and its children as instances, is applied to already taken actors on their next take. */
+	UFUNCTION(BlueprintCallable, Category = "Pool Factory")
+	void EnableInstancedProxy(TSubclassOf<AActor> ActorClass);
+
+	/** Stops rendering actors of given class as instances, all of them are promoted right away. */
+	UFUNCTION(BlueprintCallable, Category = "Pool Factory")
+	void DisableInstancedProxy(TSubclassOf<AActor> ActorClass);
+
+	/** Returns true if taken actors of given class are rendered as instances. */
+	UFUNCTION(BlueprintPure, Category = "Pool Factory")
+	bool IsInstancedProxyEnabled(const UClass* ActorClass) const;
+
+	/** Returns true if given taken actor is rendered as instance, false if it is promoted or its class is not in the instanced proxy mode. */
+	UFUNCTION(BlueprintPure, Category = "Pool Factory")
+	bool IsRenderedAsInstance(const AActor* Actor) const { return Actor && ProxySlotsInternal.Contains(Actor); }
+
+	/** Shows own static mesh of given taken actor instead of its instance, e.g: once gameplay changes its material or attaches effects.
+	 * The actor is rendered as instance again when it is taken next time. */
+	UFUNCTION(BlueprintCallable, Category = "Pool Factory")
+	void PromoteActor(AActor* Actor);
+
+protected:
+	/** Pool-owned instanced mesh of one actor class, each taken actor occupies own slot that is instance index. */
+	struct FPoolInstancedProxy
+	{
+		TWeakObjectPtr<UInstancedStaticMeshComponent> InstancedMesh = nullptr;
+		TArray<TWeakObjectPtr<AActor>> SlotActors;
+		TArray<int32> FreeSlots;
+	};
+
+	/** Actor classes which taken actors are rendered as instances, more could be added by EnableInstancedProxy(). */
+	UPROPERTY(EditDefaultsOnly, BlueprintReadWrite, Category = "Pool Factory", meta = (BlueprintProtected))
+	TArray<TSubclassOf<AActor>> InstancedProxyClasses;
+
+	/** Instanced meshes by exact actor classes, since children classes could have other meshes. */
+	TMap<TObjectKey<UClass>, FPoolInstancedProxy> InstancedProxiesInternal;
+
+	/** Instance of one actor that is rendered as instance right now. */
+	struct FPoolProxySlot
+	{
+		/** Instance index in the instanced mesh of the actor class. */
+		int32 Slot = INDEX_NONE;
+
+		/** Visibility of own static mesh before it was hidden for the instance, is restored once the slot is released. */
+		bool bWasMeshVisible = true;
+	};
+
+	/** Slots of actors that are rendered as instances right now. */
+	TMap<TObjectKey<AActor>, FPoolProxySlot> ProxySlotsInternal;
+
+	/** Instanced meshes which instances were moved this frame, their render state is updated once on next tick. */
+	TArray<TWeakObjectPtr<UInstancedStaticMeshComponent>> DirtyInstancedMeshesInternal;
+
+	/** Transient actor that owns all instanced meshes of this factory. */
+	UPROPERTY(Transient)
+	TObjectPtr<AActor> InstancedProxiesHostInternal = nullptr;
+
+	/** Returns the static mesh of given actor that is replaced by instance: its root or the first one. */
+	static UStaticMeshComponent* GetProxiedMesh(const AActor& Actor);
+
+	/** Returns instanced mesh of given actor class, creates it on first call by given source mesh. */
+	UInstancedStaticMeshComponent* GetOrCreateInstancedMesh(const UClass* ActorClass, const UStaticMeshComponent& SourceMesh);
+
+	/** Replaces own static mesh of given actor by instance on taking, or frees its instance on returning. */
+	virtual void SetInstancedProxyStateInPool(AActor& Actor, bool bActivate);
+
+	/** Frees the instance of given actor and restores visibility of its own static mesh, does nothing if it is not rendered as instance.
+	 * Free instance is collapsed to zero scale at its last location, so returning actors free it before they are moved away. */
+	void ReleaseProxySlot(AActor& Actor);
+
+	/** Is called when proxied static mesh of any actor is moved to move its instance as well. */
+	void OnProxiedMeshMoved(USceneComponent* UpdatedComponent, EUpdateTransformFlags UpdateTransformFlags, ETeleportType Teleport);
+
+	/** Updates render state of given instanced mesh once on next tick, no matter how many of its instances are moved this frame. */
+	void MarkInstancedMeshDirty(UInstancedStaticMeshComponent& InstancedMesh);
+
+	/** Updates render state of all instanced meshes which instances were moved last frame. */
+	void OnNextTickUpdateInstancedMeshes();
+
+	/*********************************************************************************************
+	 * Network
+	 ********************************************************************************************* */
+public:
+	/** Returns true if given actor is replicated by this server and can be put into network dormancy while it is in the pool. */
+	UFUNCTION(BlueprintPure, Category = "Pool Factory")
+	virtual bool CanBeDormantInPool(const AActor* Actor) const;
+
+protected:
+	/** If true, returned replicated actors are put into full dormancy, so idle pool members cost nothing for the net driver.
+	 * On taking, dormancy is flushed and all activation changes are sent in one replicated update.
+	 * Is opt-in, since it changes replication of pooled actors, e.g: properties changed on the server while the actor is free are not sent until it's taken. */
+	UPROPERTY(EditDefaultsOnly, BlueprintReadWrite, Category = "Pool Factory", meta = (BlueprintProtected))
+	bool bUseNetDormancyInPool = false;
+
+	/** Puts given actor into full dormancy, is called when actor is returned and all its changes are done. */
+	virtual void EnterNetDormancy(AActor& Actor);
+
+	/** Flushes dormancy and restores default one of given actor, is called before actor's changes on taking from pool. */
+	virtual void LeaveNetDormancy(AActor& Actor);
 };
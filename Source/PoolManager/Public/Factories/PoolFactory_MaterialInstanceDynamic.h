@@ -0,0 +1,179 @@
+﻿// Copyright (c) Yevhenii Selivanov
+
+#pragma once
+
+#include "Factories/PoolFactory_UObject.h"
+//---
+#include "PoolFactory_MaterialInstanceDynamic.generated.h"
+
+class UMaterialInterface;
+class UMaterialInstanceDynamic;
+class UTexture;
+
+/**
+ * Is passed as the payload on taking Material Instance Dynamic from the pool to specify its parent material.
+ */
+USTRUCT(BlueprintType)
+struct POOLMANAGER_API FPoolMaterialPayload
+{
+	GENERATED_BODY()
+
+	/** The parent material of requested Material Instance Dynamic. */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Transient)
+	TObjectPtr<UMaterialInterface> ParentMaterial = nullptr;
+};
+
+/**
+ * Is responsible for managing Material Instance Dynamics, their pools are keyed by parent materials:
+ * Creation: call UMaterialInstanceDynamic::Create with the parent material from FPoolMaterialPayload.
+ * Pool: instances are kept in sub-pools by parent materials, so taking looks only through free instances of requested parent,
+ * their overridden parameters are reset to parent values on return.
+ * Does not touch render resources directly, so works headless with the null RHI as well.
+ *
+ * Take it by passing the parent material as the payload:
+ * UPoolManagerSubsystem::Get().TakeFromPool(UMaterialInstanceDynamic::StaticClass(), FTransform::Identity, OnTaken, ESpawnRequestPriority::Normal, UPoolFactory_MaterialInstanceDynamic::MakePayload(ParentMaterial));
+ * Pre-warm and shrink it by PrewarmMaterials() and ShrinkMaterials() of this factory, since the Pool Manager does not know parent materials.
+ */
+UCLASS()
+class POOLMANAGER_API UPoolFactory_MaterialInstanceDynamic : public UPoolFactory_UObject
+{
+	GENERATED_BODY()
+
+	/*********************************************************************************************
+	 * Setup overrides
+	 ********************************************************************************************* */
+public:
+	/** Is overridden to handle Material Instance Dynamics. */
+	virtual const UClass* GetObjectClass_Implementation() const override;
+
+	/** Returns the payload to take Material Instance Dynamic of given parent material from the pool. */
+	UFUNCTION(BlueprintPure, Category = "Pool Factory")
+	static FInstancedStruct MakePayload(UMaterialInterface* ParentMaterial);
+
+	/** Returns the parent material from given payload, is null if the payload is not FPoolMaterialPayload. */
+	static UMaterialInterface* GetParentMaterial(const FInstancedStruct& Payload);
+
+	/** Is overridden to listen for changes of parent materials in editor. */
+	virtual void PostInitProperties() override;
+
+	/** Is overridden to stop listening for changes of parent materials and clear cached values. */
+	virtual void BeginDestroy() override;
+
+	/*********************************************************************************************
+	 * Creation
+	 ********************************************************************************************* */
+public:
+	/** Is overridden to reject requests with no parent material in the payload. */
+	virtual bool CanSpawn(const FSpawnRequest& Request) const override;
+
+	/** Is overridden to count misses of the sub-pool of requested parent material. */
+	virtual void RequestSpawn_Implementation(const FSpawnRequest& Request) override;
+
+	/** Is overridden to create Material Instance Dynamic of the parent material from request's payload. */
+	virtual UObject* SpawnNow_Implementation(const FSpawnRequest& Request) override;
+
+	/*********************************************************************************************
+	 * Destruction
+	 ********************************************************************************************* */
+public:
+	/** Is overridden to remove destroyed material from its sub-pool, cached values of its parent are cleared once the parent has no materials. */
+	virtual void Destroy_Implementation(UObject* Object) override;
+
+	/*********************************************************************************************
+	 * Pool
+	 ********************************************************************************************* */
+public:
+	/** Is overridden to take only Material Instance Dynamics of the parent material from given payload. */
+	virtual bool CanTakeFromPool(const UObject* Object, const FInstancedStruct& Payload) const override;
+
+	/** Is overridden to take free material from the sub-pool of the parent material from given payload instead of looking through the whole pool. */
+	virtual FPoolObjectData* FindFreeObject(FPoolContainer& Pool, const FInstancedStruct& Payload) override;
+
+	/** Is overridden to keep sub-pools of parent materials up to date. */
+	virtual void OnChangedStateInPool_Implementation(EPoolObjectState NewState, UObject* InObject) override;
+
+	/** Is overridden to reset overridden parameters to values of the parent material. */
+	virtual void OnReturnToPool_Implementation(UObject* Object) override;
+
+	/*********************************************************************************************
+	 * Sub-Pools
+	 * Material Instance Dynamics share one pool of their class, while each parent material has own sub-pool with its sizing and statistics.
+	 ********************************************************************************************* */
+public:
+	/** Materials of one parent material. */
+	struct FPoolMaterialSubPool
+	{
+		/** All registered materials of the parent, both active and free. */
+		TSet<TWeakObjectPtr<UMaterialInstanceDynamic>> Materials;
+
+		/** Free materials of the parent that are ready to be taken. */
+		TSet<TWeakObjectPtr<UMaterialInstanceDynamic>> FreeMaterials;
+
+		/** Number of takes of the parent that found free material. */
+		int32 HitsNum = 0;
+
+		/** Number of takes of the parent that had to create new material. */
+		int32 MissesNum = 0;
+	};
+
+	/** Returns the sub-pool of given parent material or null if there are no its materials. */
+	const FORCEINLINE FPoolMaterialSubPool* FindSubPool(const UMaterialInterface* ParentMaterial) const { return SubPoolsInternal.Find(ParentMaterial); }
+
+	/** Returns number of registered materials of given parent material, both active and free. */
+	UFUNCTION(BlueprintPure, Category = "Pool Factory")
+	int32 GetMaterialsNum(const UMaterialInterface* ParentMaterial) const;
+
+	/** Returns number of free materials of given parent material. */
+	UFUNCTION(BlueprintPure, Category = "Pool Factory")
+	int32 GetFreeMaterialsNum(const UMaterialInterface* ParentMaterial) const;
+
+	/** Creates free materials of given parent next frames in advance, so they are ready to be taken with no spawn.
+	 * @param ParentMaterial The parent material of materials to pre-warm.
+	 * @param Amount The total amount of materials the sub-pool should contain, already registered and queued materials are included.
+	 * @param Priority The priority of pre-warming requests.
+	 * @return Number of newly requested materials. */
+	UFUNCTION(BlueprintCallable, Category = "Pool Factory")
+	int32 PrewarmMaterials(UMaterialInterface* ParentMaterial, int32 Amount, ESpawnRequestPriority Priority = ESpawnRequestPriority::Normal);
+
+	/** Destroys free materials of given parent right away until its sub-pool contains specified amount of them.
+	 * Active materials are never destroyed, so the sub-pool could stay bigger than specified amount. */
+	UFUNCTION(BlueprintCallable, Category = "Pool Factory")
+	void ShrinkMaterials(UMaterialInterface* ParentMaterial, int32 Amount);
+
+protected:
+	/** Sub-pools by parent materials. */
+	TMap<TObjectKey<UMaterialInterface>, FPoolMaterialSubPool> SubPoolsInternal;
+
+	/*********************************************************************************************
+	 * Parent Values
+	 * Values of parent materials are cached, so returning is not looking for them in the parent on each return.
+	 ********************************************************************************************* */
+protected:
+	/** Cached texture of one parameter, is kept even if the parent has no texture set, so it's not looked up again. */
+	struct FPoolMaterialTextureValue
+	{
+		TWeakObjectPtr<UTexture> Texture = nullptr;
+
+		/** Is false if the parent has no such parameter at all. */
+		bool bIsResolved = false;
+	};
+
+	/** Cached values of global parameters of one parent material. */
+	struct FPoolMaterialParentValues
+	{
+		TMap<FName, float> Scalars;
+		TMap<FName, FLinearColor> Vectors;
+		TMap<FName, FPoolMaterialTextureValue> Textures;
+	};
+
+	/** Cached values by parent materials. */
+	TMap<TWeakObjectPtr<const UMaterialInterface>, FPoolMaterialParentValues> ParentValuesInternal;
+
+	/** Sets only overridden parameters of given material back to values of its parent. */
+	virtual void ResetToParentValues(UMaterialInstanceDynamic& Material);
+
+#if WITH_EDITOR
+	/** Clears cached values once any material is changed in editor, since children of changed material inherit its values as well. */
+	void OnObjectPropertyChanged(UObject* Object, FPropertyChangedEvent& PropertyChangedEvent);
+#endif // WITH_EDITOR
+};
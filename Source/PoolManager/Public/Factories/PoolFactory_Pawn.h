@@ -0,0 +1,85 @@
+﻿// Copyright (c) Yevhenii Selivanov
+
+#pragma once
+
+#include "Factories/PoolFactory_Actor.h"
+//---
+#include "PoolFactory_Pawn.generated.h"
+
+class APawn;
+class AController;
+class UAISense;
+class UAIPerceptionStimuliSourceComponent;
+
+/**
+ * Is responsible for managing pawns together with their AI controllers, it handles such differences in pawns as:
+ * Creation: the controller is spawned once with the pawn and is never destroyed while the pawn is pooled.
+ * Pool: on return, the brain logic is stopped, movement and perception are disabled and perception stimuli are unregistered,
+ *       on take, the pawn is possessed again only if it lost its controller, the brain logic is restarted,
+ *       and only senses and stimuli that were enabled on return are enabled again.
+ * Destruction: the controller is destroyed together with its pawn.
+ */
+UCLASS()
+class POOLMANAGER_API UPoolFactory_Pawn : public UPoolFactory_Actor
+{
+	GENERATED_BODY()
+
+	/*********************************************************************************************
+	 * Setup overrides
+	 ********************************************************************************************* */
+public:
+	/** Is overridden to handle Pawn-inherited classes. */
+	virtual const UClass* GetObjectClass_Implementation() const override;
+
+	/*********************************************************************************************
+	 * Creation
+	 ********************************************************************************************* */
+public:
+	/** Is overridden to stop the logic of pre-warmed pawn, since its controller starts it on spawning. */
+	virtual void OnPreRegistered(const FSpawnRequest& Request, const FPoolObjectData& ObjectData) override;
+
+	/*********************************************************************************************
+	 * Destruction
+	 ********************************************************************************************* */
+public:
+	/** Is overridden to destroy the controller together with its pawn and remove its recorded AI state. */
+	virtual void Destroy_Implementation(UObject* Object) override;
+
+	/*********************************************************************************************
+	 * Pool
+	 ********************************************************************************************* */
+protected:
+	/** Is overridden to pause or resume the controller of the pawn together with the actor. */
+	virtual void SetActorStateInPool(AActor& Actor, bool bActivate) override;
+
+	/** Stops or restarts the brain, movement and perception of given pawn and its controller.
+	 * Is not applied to pawns that are not initialized yet, since their controller is spawned only once spawning is finished. */
+	virtual void SetControllerStateInPool(APawn& Pawn, bool bActivate);
+
+	/** If true, the controller of returned pawn is kept paused instead of being destroyed, so it is possessed again on take. */
+	UPROPERTY(EditDefaultsOnly, BlueprintReadWrite, Category = "Pool Factory", meta = (BlueprintProtected))
+	bool bPoolControllers = true;
+
+	/** Returns true if given stimuli source registers itself with the perception system.
+	 * Is used as its registration state, since the engine does not expose whether the source is registered. */
+	static bool IsAutoRegisteredAsSource(const UAIPerceptionStimuliSourceComponent& StimuliSource);
+
+	/** AI state of one pooled pawn that is recorded on return, so exactly the same state is restored on take. */
+	struct FPoolPawnAIState
+	{
+		/** Last AI controller of the pawn, is used to possess the pawn again if gameplay code unpossessed it, e.g: on death. */
+		TWeakObjectPtr<AController> Controller = nullptr;
+
+		/** Is true if the pawn was possessed by AI controller, only such pawns get a new default controller if their one was destroyed. */
+		bool bHadAIController = false;
+
+		/** Perception senses of the controller that were enabled on return. */
+		TArray<TSubclassOf<UAISense>> EnabledSenses;
+
+		/** Is true if the stimuli source of the pawn was registered on return. */
+		bool bIsStimuliSourceRegistered = false;
+	};
+
+	/** Recorded AI states of pooled pawns, is removed on destroying the pawn by the pool or once the pawn is found destroyed by gameplay code. */
+	TMap<TWeakObjectPtr<APawn>, FPoolPawnAIState> PooledAIStatesInternal;
+};
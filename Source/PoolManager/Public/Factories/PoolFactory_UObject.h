@@ -2,12 +2,15 @@
 
 #pragma once
 
+#include "Engine/TimerHandle.h"
 #include "UObject/Object.h"
 //---
 #include "PoolManagerTypes.h"
 //---
 #include "PoolFactory_UObject.generated.h"
 
+class UPoolManagerSubsystem;
+
 /**
  * Each factory implements specific logic of creating and managing objects of its class and its children.
  * Factories are designed to handle such differences as:
@@ -35,6 +38,10 @@ public:
 	const UClass* GetObjectClass() const;
 	virtual FORCEINLINE const UClass* GetObjectClass_Implementation() const { return UObject::StaticClass(); }
 
+	/** Returns the Pool Manager that owns this factory, is null for the factory of shared pools. */
+	UFUNCTION(BlueprintPure, Category = "Pool Factory")
+	UPoolManagerSubsystem* GetPoolManager() const;
+
 	/*********************************************************************************************
 	 * Creation
 	 * RequestSpawn -> DequeueSpawnRequest -> SpawnNow -> OnPreRegistered -> OnPostSpawned
@@ -46,6 +53,10 @@ public:
 	void RequestSpawn(const FSpawnRequest& Request);
 	virtual void RequestSpawn_Implementation(const FSpawnRequest& Request);
 
+	/** Returns true if given request can be spawned, e.g: material instances can't be created with no parent material.
+	 * Rejected request is completed with no object, so it never reaches 'SpawnNow'. */
+	virtual FORCEINLINE bool CanSpawn(const FSpawnRequest& Request) const { return true; }
+
 	/** Removes the first spawn request from the queue and returns it.
 	 * Is called after 'RequestSpawn'. */
 	UFUNCTION(BlueprintCallable, Category = "Pool Factory")
@@ -56,7 +67,8 @@ public:
 	void ProcessRequestNow(const FSpawnRequest& Request);
 
 	/** Method to immediately spawn requested object.
-	 * Is called after 'DequeueSpawnRequest'. */
+	 * Is called after 'DequeueSpawnRequest'.
+	 * Request's Payload is available here to configure the object before it is finished. */
 	UFUNCTION(BlueprintNativeEvent, BlueprintCallable, Category = "Pool Factory", meta = (AutoCreateRefTerm = "Request"))
 	UObject* SpawnNow(const FSpawnRequest& Request);
 	virtual UObject* SpawnNow_Implementation(const FSpawnRequest& Request);
@@ -69,6 +81,25 @@ public:
 	UFUNCTION(BlueprintPure, Category = "Pool Factory")
 	virtual FORCEINLINE bool IsSpawnQueueEmpty() const { return SpawnQueueInternal.IsEmpty(); }
 
+	/** Returns all queued spawn requests ordered by priority. */
+	const FORCEINLINE TArray<FSpawnRequest>& GetSpawnQueue() const { return SpawnQueueInternal; }
+
+	/** Returns number of queued spawn requests of specified class. */
+	UFUNCTION(BlueprintPure, Category = "Pool Factory")
+	int32 GetSpawnRequestsNum(const UClass* ObjectClass) const;
+
+	/** Removes queued pre-warming requests of specified class that are not spawned yet.
+	 * @param ObjectClass The class of requests to cancel.
+	 * @param MaxNum The maximum number of requests to cancel.
+	 * @return Number of cancelled requests. */
+	UFUNCTION(BlueprintCallable, Category = "Pool Factory")
+	virtual int32 CancelPrewarmRequests(const UClass* ObjectClass, int32 MaxNum);
+
+	/** Spawns all queued requests right now regardless of the spawn budget.
+	 * Is useful for debugging or when a hitch is acceptable, e.g: behind the loading screen. */
+	UFUNCTION(BlueprintCallable, Category = "Pool Factory")
+	virtual void FlushSpawnQueue();
+
 	/** Is called right after object is spawned and before it is registered in the Pool.
 	 * Is called after 'SpawnNow'. */
 	UFUNCTION(BlueprintCallable, Category = "C++")
@@ -85,6 +116,34 @@ protected:
 	void OnNextTickProcessSpawn();
 	virtual void OnNextTickProcessSpawn_Implementation();
 
+	/** Returns a limit of how many objects to spawn per frame according to the budget mode of the Pool Manager. */
+	UFUNCTION(BlueprintPure, Category = "Pool Factory", meta = (BlueprintProtected))
+	int32 GetSpawnObjectsPerFrame() const;
+
+	/** Returns milliseconds that spawning can take per frame according to the budget mode of the Pool Manager, 0 if not limited. */
+	UFUNCTION(BlueprintPure, Category = "Pool Factory", meta = (BlueprintProtected))
+	float GetSpawnBudgetMs() const;
+
+	/*********************************************************************************************
+	 * Cost
+	 * Moving estimates of spawn, take and return time per class, is measured automatically.
+	 ********************************************************************************************* */
+public:
+	/** Returns measured costs of objects of given class, e.g: to pre-warm only classes that are expensive to spawn. */
+	UFUNCTION(BlueprintPure, Category = "Pool Factory")
+	FPoolSpawnCost GetSpawnCost(const UClass* ObjectClass) const { return SpawnCostsInternal.FindRef(ObjectClass); }
+
+	/** Adds measured time of SpawnNow and OnPreRegistered to the spawn cost of given class.
+	 * Warns once per class if one object costs more than the whole spawn budget. */
+	virtual void AddSpawnCostSample(const UClass* ObjectClass, double Seconds);
+
+	/** Adds measured time of taking or returning the object to the cost of given class.
+	 * Is called by the Pool Manager.
+	 * @param ObjectClass The class of the object.
+	 * @param NewState Active if the object was taken, Inactive if it was returned.
+	 * @param Seconds Measured time. */
+	virtual void AddActivationCostSample(const UClass* ObjectClass, EPoolObjectState NewState, double Seconds);
+
 	/*********************************************************************************************
 	 * Destruction
 	 ********************************************************************************************* */
@@ -98,10 +157,26 @@ public:
 	 * Pool
 	 ********************************************************************************************* */
 public:
-	/** Is called right before taking the object from its pool. */
-	UFUNCTION(BlueprintNativeEvent, BlueprintCallable, Category = "Pool Factory", meta = (AutoCreateRefTerm = "Transform"))
-	void OnTakeFromPool(UObject* Object, const FTransform& Transform);
-	virtual void OnTakeFromPool_Implementation(UObject* Object, const FTransform& Transform);
+	/** Is called right before taking the object from its pool.
+	 * @param Object The object to take from the pool.
+	 * @param Transform The transform to set for the object (if actor).
+	 * @param Payload Optional data to configure the object in one pass before it becomes active. */
+	UFUNCTION(BlueprintNativeEvent, BlueprintCallable, Category = "Pool Factory", meta = (AutoCreateRefTerm = "Transform,Payload"))
+	void OnTakeFromPool(UObject* Object, const FTransform& Transform, const FInstancedStruct& Payload);
+	virtual void OnTakeFromPool_Implementation(UObject* Object, const FTransform& Transform, const FInstancedStruct& Payload);
+
+	/** Is the old signature with no payload, is called by the base implementation of the new one.
+	 * Child factories that override only the new signature should add 'using Super::OnTakeFromPool_Implementation;' to keep this one visible. */
+	UE_DEPRECATED(5.5, "Override OnTakeFromPool_Implementation with the Payload parameter instead.")
+	virtual void OnTakeFromPool_Implementation(UObject* Object, const FTransform& Transform) {}
+
+	/** Returns true if given free object can be taken for requested payload, e.g: material instances are taken only for the same parent material.
+	 * Is called by the Pool Manager for each free object while looking for the one to take. */
+	virtual FORCEINLINE bool CanTakeFromPool(const UObject* Object, const FInstancedStruct& Payload) const { return true; }
+
+	/** Returns free object of given pool to take for requested payload or null if there are no such objects.
+	 * By default, looks through the whole pool by 'CanTakeFromPool', could be overridden to keep own sub-pools, e.g: by parent materials. */
+	virtual FPoolObjectData* FindFreeObject(FPoolContainer& Pool, const FInstancedStruct& Payload);
 
 	/** Is called right before returning the object back to its pool. */
 	UFUNCTION(BlueprintNativeEvent, BlueprintCallable, Category = "Pool Factory")
@@ -113,6 +188,18 @@ public:
 	void OnChangedStateInPool(EPoolObjectState NewState, UObject* InObject);
 	virtual void OnChangedStateInPool_Implementation(EPoolObjectState NewState, UObject* InObject);
 
+	/** Returns true if given free object can be kept by the game instance to be adopted by the next world's Pool Manager.
+	 * Is called on destroying the world only if 'Persist Pools Across Travel' is enabled in the settings. */
+	UFUNCTION(BlueprintNativeEvent, BlueprintPure, Category = "Pool Factory")
+	bool CanPersistAcrossTravel(const UObject* Object) const;
+	virtual FORCEINLINE bool CanPersistAcrossTravel_Implementation(const UObject* Object) const { return IsValid(Object); }
+
+	/** Returns estimated memory in bytes used by given object.
+	 * Is called once per pool to estimate how much memory its objects take, e.g: for 'PoolManager.MemoryBudgetMB'. */
+	UFUNCTION(BlueprintNativeEvent, BlueprintPure, Category = "Pool Factory")
+	int64 EstimateObjectSize(const UObject* Object) const;
+	virtual int64 EstimateObjectSize_Implementation(const UObject* Object) const;
+
 	/*********************************************************************************************
 	 * Data
 	 ********************************************************************************************* */
@@ -120,4 +207,11 @@ protected:
 	/** All request to spawn. */
 	UPROPERTY(VisibleInstanceOnly, BlueprintReadWrite, Transient, AdvancedDisplay, Category = "Pool Factory", meta = (BlueprintProtected, DisplayName = "Spawn Queue"))
 	TArray<FSpawnRequest> SpawnQueueInternal;
+
+	/** Measured costs by classes of objects. */
+	UPROPERTY(VisibleInstanceOnly, BlueprintReadOnly, Transient, AdvancedDisplay, Category = "Pool Factory", meta = (BlueprintProtected, DisplayName = "Spawn Costs"))
+	TMap<TObjectPtr<const UClass>, FPoolSpawnCost> SpawnCostsInternal;
+
+	/** Is set while processing of the spawn queue is scheduled for next frame. */
+	FTimerHandle SpawnTimerInternal;
 };
@@ -0,0 +1,53 @@
+﻿// Copyright (c) Yevhenii Selivanov
+
+#pragma once
+
+#include "Subsystems/GameInstanceSubsystem.h"
+//---
+#include "PoolManagerTypes.h"
+//---
+#include "PoolManagerPersistentSubsystem.generated.h"
+
+class UPoolManagerSubsystem;
+
+/**
+ * Is opt-in game-instance-level store that keeps free pooled objects through seamless travel and level transitions.
+ * Is created only if 'Persist Pools Across Travel' is enabled in 'Project Settings' -> "Plugins" -> "Pool Manager".
+ *
+ * How it works:
+ *     - When the world is destroyed, its Pool Manager stashes here all free objects which factories allow to persist.
+ *     - UObjects and Widgets are always kept, actors are kept only if they travel with the game mode's seamless travel list.
+ *     - Pool Manager of the next world adopts stashed objects, so its pools are ready with no destroy and respawn cycle.
+ */
+UCLASS()
+class POOLMANAGER_API UPoolManagerPersistentSubsystem : public UGameInstanceSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	/** Returns the store of given world's game instance, or null if persistence is disabled. */
+	static UPoolManagerPersistentSubsystem* GetPersistentStore(const UObject* WorldContext);
+
+	/** Is overridden to create the store only if persistence is enabled in the settings. */
+	virtual bool ShouldCreateSubsystem(UObject* Outer) const override;
+
+	/** Keeps given free object until next world adopts it.
+	 * Is called by the Pool Manager of the world that is going to be destroyed. */
+	virtual void StashObject(const FPoolObjectData& InData);
+
+	/** Registers all stashed objects that are ready to be adopted in the pools of given Pool Manager.
+	 * Actors that are still traveling are kept until they appear in the world of given Pool Manager. */
+	virtual void AdoptObjects(UPoolManagerSubsystem& PoolManager);
+
+	/** Returns number of objects that wait for the next world. */
+	UFUNCTION(BlueprintPure, Category = "Pool Manager")
+	int32 GetStashedObjectsNum() const { return StashedObjectsInternal.Num(); }
+
+protected:
+	/** Free objects that wait for the next world. */
+	UPROPERTY(VisibleInstanceOnly, BlueprintReadOnly, Transient, Category = "Pool Manager", meta = (BlueprintProtected, DisplayName = "Stashed Objects"))
+	TArray<FPoolObjectData> StashedObjectsInternal;
+
+	/** Is called on deinitialization of the store to destroy all objects that were never adopted. */
+	virtual void Deinitialize() override;
+};
@@ -0,0 +1,121 @@
+﻿// Copyright (c) Yevhenii Selivanov
+
+#pragma once
+
+#include "Subsystems/EngineSubsystem.h"
+//---
+#include "PoolManagerTypes.h"
+//---
+#include "PoolManagerSharedSubsystem.generated.h"
+
+class UPoolFactory_UObject;
+
+/**
+ * Is engine-scoped pool tier for data-only UObjects that don't depend on any world.
+ * Is useful when one process hosts multiple worlds (e.g. dedicated server with several matches, or multiple PIE instances):
+ * instead of duplicating the same pools in each world's Pool Manager, all worlds lease objects from the same shared pools.
+ *
+ * How it works:
+ *     - Object is leased by the world, so memory scales with peak concurrent use rather than with the number of worlds.
+ *     - Leased object is returned back by ReturnLease(), or automatically when its world is cleaned up.
+ *     - Objects are created and returned synchronously on the game thread, so worlds that tick one after another never share a lease.
+ *     - Only classes that are handled by the base UObject factory are supported, actors, widgets etc. depend on the world.
+ */
+UCLASS()
+class POOLMANAGER_API UPoolManagerSharedSubsystem : public UEngineSubsystem
+{
+	GENERATED_BODY()
+
+	/*********************************************************************************************
+	 * Static Getters
+	 ********************************************************************************************* */
+public:
+	/** Returns the shared Pool Manager, is checked and will crash if can't be obtained. */
+	static UPoolManagerSharedSubsystem& Get();
+
+	/** Returns true if objects of given class don't depend on the world, so can be pooled in shared pools. */
+	UFUNCTION(BlueprintPure, Category = "Pool Manager")
+	static bool IsWorldIndependentClass(const UClass* ObjectClass);
+
+	/*********************************************************************************************
+	 * Lease
+	 ********************************************************************************************* */
+public:
+	/** Takes free object from the shared pool, or creates new one if there are no free objects, and leases it to the world of given context.
+	 * @param ObjectClass The class of object to lease, has to be world independent.
+	 * @param WorldContext The object of the world that leases the object, its lease is returned automatically when the world is cleaned up.
+	 * @param Payload Optional data to configure the object in one activation step.
+	 * @return Leased object, or null if the class is not supported. */
+	virtual UObject* LeaseFromSharedPool(const UClass* ObjectClass, const UObject* WorldContext, const FInstancedStruct& Payload = FInstancedStruct());
+
+	/** Is blueprint version of LeaseFromSharedPool(). */
+	UFUNCTION(BlueprintCallable, Category = "Pool Manager", meta = (WorldContext = "WorldContext", DeterminesOutputType = "ObjectClass", AutoCreateRefTerm = "Payload"))
+	UObject* BPLeaseFromSharedPool(const UClass* ObjectClass, const UObject* WorldContext, const FInstancedStruct& Payload) { return LeaseFromSharedPool(ObjectClass, WorldContext, Payload); }
+
+	/** Returns leased object back to the shared pool, so any world can lease it again.
+	 * @return true if the object was leased and is returned successfully. */
+	UFUNCTION(BlueprintCallable, Category = "Pool Manager")
+	virtual bool ReturnLease(UObject* Object);
+
+	/** Returns all objects leased by given world back to the shared pools.
+	 * Is called automatically when the world is cleaned up. */
+	UFUNCTION(BlueprintCallable, Category = "Pool Manager")
+	virtual void ReturnAllLeases(const UWorld* World);
+
+	/** Destroys free objects of given class in the shared pool, but keeps specified amount of them. */
+	UFUNCTION(BlueprintCallable, Category = "Pool Manager")
+	virtual void TrimSharedPool(const UClass* ObjectClass, int32 KeepFreeObjectsNum = 0);
+
+	/*********************************************************************************************
+	 * Getters
+	 ********************************************************************************************* */
+public:
+	/** Returns number of free objects in the shared pool by specified class. */
+	UFUNCTION(BlueprintPure, Category = "Pool Manager")
+	int32 GetFreeObjectsNum(const UClass* ObjectClass) const;
+
+	/** Returns number of objects leased by given world, or by all worlds if null. */
+	UFUNCTION(BlueprintPure, Category = "Pool Manager")
+	int32 GetLeasedObjectsNum(const UWorld* World = nullptr) const;
+
+	/** Returns the highest number of objects of given class leased at the same time by all worlds. */
+	UFUNCTION(BlueprintPure, Category = "Pool Manager")
+	int32 GetPeakLeasedObjectsNum(const UClass* ObjectClass) const { return PeakLeasedNumInternal.FindRef(ObjectClass); }
+
+	/*********************************************************************************************
+	 * Protected properties
+	 ********************************************************************************************* */
+protected:
+	/** Contains all shared pools. */
+	UPROPERTY(VisibleInstanceOnly, BlueprintReadOnly, Transient, Category = "Pool Manager", meta = (BlueprintProtected, DisplayName = "Shared Pools"))
+	TArray<FPoolContainer> PoolsInternal;
+
+	/** Factory that creates and manages objects of all shared pools. */
+	UPROPERTY(VisibleInstanceOnly, BlueprintReadOnly, Transient, Category = "Pool Manager", meta = (BlueprintProtected, DisplayName = "Factory"))
+	TObjectPtr<UPoolFactory_UObject> FactoryInternal = nullptr;
+
+	/** Worlds that lease objects by handles of these objects. */
+	TMap<FPoolObjectHandle, TObjectKey<UWorld>> LeasesInternal;
+
+	/** The highest number of objects leased at the same time by classes. */
+	UPROPERTY(VisibleInstanceOnly, BlueprintReadOnly, Transient, Category = "Pool Manager", meta = (BlueprintProtected, DisplayName = "Peak Leased Num"))
+	TMap<TObjectPtr<const UClass>, int32> PeakLeasedNumInternal;
+
+	/*********************************************************************************************
+	 * Protected methods
+	 ********************************************************************************************* */
+protected:
+	/** Is called on initialization of the shared Pool Manager instance. */
+	virtual void Initialize(FSubsystemCollectionBase& Collection) override;
+
+	/** Is called on deinitialization of the shared Pool Manager instance. */
+	virtual void Deinitialize() override;
+
+	/** Returns the pool by specified class. */
+	FPoolContainer& FindPoolOrAdd(const UClass* ObjectClass);
+	FPoolContainer* FindPool(const UClass* ObjectClass) { return PoolsInternal.FindByKey(ObjectClass); }
+	const FORCEINLINE FPoolContainer* FindPool(const UClass* ObjectClass) const { return PoolsInternal.FindByKey(ObjectClass); }
+
+	/** Is called when any world is cleaned up to return all its leases. */
+	virtual void OnWorldCleanup(UWorld* World, bool bSessionEnded, bool bCleanupResources);
+};
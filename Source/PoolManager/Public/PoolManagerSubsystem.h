@@ -3,11 +3,19 @@
 #pragma once
 
 #include "Subsystems/WorldSubsystem.h"
+#include "UObject/ObjectKey.h"
 //---
 #include "PoolManagerTypes.h"
 //---
 #include "PoolManagerSubsystem.generated.h"
 
+class ULevel;
+class UDataLayerInstance;
+class USceneComponent;
+enum class EDataLayerRuntimeState : uint8;
+enum class EUpdateTransformFlags : int32;
+enum class ETeleportType : uint8;
+
 /**
  * The Pool Manager helps reuse objects that show up often instead of creating and destroying them each time.
  *
@@ -81,27 +89,29 @@ public:
 	 *  @param Transform The transform to set for the object (if actor).
 	 *  @param Completed The callback output that is called when the object is ready.
 	 *  @param Priority The priority of the request, higher priority objects are spawned first.
+	 *  @param Payload Optional data to configure the object in one activation step, is passed to the factory and IPoolObjectCallback.
 	 *  @return if any is found and free, activates and returns object from the pool, otherwise async spawns new one next frames and register in the pool.
 	 *  @warning BP-ONLY: in code, use TakeFromPool() instead. 
 	 *  - 'SpawnObjectsPerFrame' affects how fast new objects are created, it can be changed in 'Project Settings' -> "Plugins" -> "Pool Manager".
 	 *  - Is custom blueprint node implemented in K2Node_TakeFromPool.h, so can't be overridden and accessible on graph (not inside functions).
 	 *  - use BPTakeFromPoolArray instead of requesting one by one in for/while: 'Completed' output does not work in loops. */
-	UFUNCTION(BlueprintCallable, Category = "Pool Manager", DisplayName = "Take From Pool", meta = (BlueprintInternalUseOnly = "true", AutoCreateRefTerm = "Transform"))
-	void BPTakeFromPool(const UClass* ObjectClass, const FTransform& Transform, const FOnTakenFromPool& Completed, ESpawnRequestPriority Priority);
+	UFUNCTION(BlueprintCallable, Category = "Pool Manager", DisplayName = "Take From Pool", meta = (BlueprintInternalUseOnly = "true", AutoCreateRefTerm = "Transform,Payload"))
+	void BPTakeFromPool(const UClass* ObjectClass, const FTransform& Transform, const FOnTakenFromPool& Completed, ESpawnRequestPriority Priority, const FInstancedStruct& Payload);
 
 	/** Is code-overridable alternative version of BPTakeFromPool() that calls callback functions when the object is ready.
 	 * Can be overridden by child code classes.
 	 * Is useful in code with blueprint classes, e.g: TakeFromPool(SomeBlueprintClass);
+	 * @param Owner Optional object that owns taken object, it's returned to the pool automatically once the owner is destroyed, see ReturnAllOwnedBy().
 	 * @return Handle to the object with the Hash associated with the object, is indirect since the object could be not ready yet. */
-	virtual FPoolObjectHandle TakeFromPool(const UClass* ObjectClass, const FTransform& Transform = FTransform::Identity, const FOnSpawnCallback& Completed = nullptr, ESpawnRequestPriority Priority = ESpawnRequestPriority::Normal);
+	virtual FPoolObjectHandle TakeFromPool(const UClass* ObjectClass, const FTransform& Transform = FTransform::Identity, const FOnSpawnCallback& Completed = nullptr, ESpawnRequestPriority Priority = ESpawnRequestPriority::Normal, const FInstancedStruct& Payload = FInstancedStruct(), UObject* Owner = nullptr);
 
 	/** A templated alternative to get the object from a pool by class in template.
 	 * Is useful in code with code classes, e.g: TakeFromPool<AProjectile>(); */
 	template <typename T>
-	FPoolObjectHandle TakeFromPool(const FTransform& Transform = FTransform::Identity, const FOnSpawnCallback& Completed = nullptr, ESpawnRequestPriority Priority = ESpawnRequestPriority::Normal) { return TakeFromPool(T::StaticClass(), Transform, Completed, Priority); }
+	FPoolObjectHandle TakeFromPool(const FTransform& Transform = FTransform::Identity, const FOnSpawnCallback& Completed = nullptr, ESpawnRequestPriority Priority = ESpawnRequestPriority::Normal, const FInstancedStruct& Payload = FInstancedStruct(), UObject* Owner = nullptr) { return TakeFromPool(T::StaticClass(), Transform, Completed, Priority, Payload, Owner); }
 
 	/** Is alternative version of TakeFromPool() to find object in pool or return null. */
-	virtual const FPoolObjectData* TakeFromPoolOrNull(const UClass* ObjectClass, const FTransform& Transform = FTransform::Identity);
+	virtual const FPoolObjectData* TakeFromPoolOrNull(const UClass* ObjectClass, const FTransform& Transform = FTransform::Identity, const FInstancedStruct& Payload = FInstancedStruct());
 
 	/*********************************************************************************************
 	 * Take From Pool (multiple objects)
@@ -119,18 +129,19 @@ public:
 	UFUNCTION(BlueprintCallable, Category = "Pool Manager", DisplayName = "Take From Pool Array", meta = (BlueprintInternalUseOnly = "true"))
 	void BPTakeFromPoolArray(const UClass* ObjectClass, int32 Amount, const FOnTakenFromPoolArray& Completed, ESpawnRequestPriority Priority);
 
-	/** Is code-overridable alternative version of BPTakeFromPoolArray() that calls callback functions when all objects of the same class are ready. */
-	virtual void TakeFromPoolArray(TArray<FPoolObjectHandle>& OutHandles, const UClass* ObjectClass, int32 Amount, const FOnSpawnAllCallback& Completed = nullptr, ESpawnRequestPriority Priority = ESpawnRequestPriority::Normal);
+	/** Is code-overridable alternative version of BPTakeFromPoolArray() that calls callback functions when all objects of the same class are ready.
+	 * @param Owner Optional object that owns all taken objects, they are returned to the pool automatically once the owner is destroyed. */
+	virtual void TakeFromPoolArray(TArray<FPoolObjectHandle>& OutHandles, const UClass* ObjectClass, int32 Amount, const FOnSpawnAllCallback& Completed = nullptr, ESpawnRequestPriority Priority = ESpawnRequestPriority::Normal, UObject* Owner = nullptr);
 
 	/** Is alternative version of TakeFromPoolArray() that can process multiple requests of different classes and different transforms at once.
 	 * @param OutHandles Returns the handles associated with objects to be spawned next frames.
-	 * @param InRequests Takes the classes and Transforms.
+	 * @param InRequests Takes the classes, Transforms and Payloads.
 	 * @param Completed The callback function that is called once when all objects are ready. */
 	virtual void TakeFromPoolArray(TArray<FPoolObjectHandle>& OutHandles, TArray<FSpawnRequest>& InRequests, const FOnSpawnAllCallback& Completed = nullptr);
 
 	/** Is alternative version of TakeFromPoolArrayOrNull() to find multiple object in pool or return null.
 	 * @param OutObjects All found and taken objects, or empty array if no one is ready yet
-	 * @param InRequests Takes the classes and Transforms. */
+	 * @param InRequests Takes the classes, Transforms and Payloads. */
 	virtual void TakeFromPoolArrayOrNull(TArray<FPoolObjectData>& OutObjects, TArray<FSpawnRequest>& InRequests);
 
 	/*********************************************************************************************
@@ -165,6 +176,114 @@ public:
 	/** Is the same as ReturnToPool() but for multiple handle. */
 	virtual bool ReturnToPoolArray(const TArray<FPoolObjectHandle>& Handles);
 
+	/*********************************************************************************************
+	 * Active Objects
+	 * Use it to iterate or return all taken objects of a class at once, e.g: to end a wave.
+	 * Only active objects are touched, so it's cheap even for big pools with many free objects.
+	 ********************************************************************************************* */
+public:
+	/** Calls given visitor for each active object of the pool by specified class.
+	 * Do not take or return objects inside the visitor, use ReturnAllActiveByPredicate() to return some of them instead. */
+	void ForEachActive(const UClass* ObjectClass, TFunctionRef<void(const FPoolObjectData& ObjectData)> Visitor) const;
+
+	/** Is the same as ForEachActive() but calls the visitor on worker threads in parallel.
+	 * Visitor has to be read-only and thread-safe: don't change objects and don't call anything that requires the game thread. */
+	void ParallelForEachActive(const UClass* ObjectClass, TFunctionRef<void(const FPoolObjectData& ObjectData)> Visitor) const;
+
+	/** Returns all active objects of given class back to the pool in one batch.
+	 * Objects that are still in the spawning queue are not returned, use ReturnToPool() by their handles instead.
+	 * @return Number of returned objects. */
+	UFUNCTION(BlueprintCallable, Category = "Pool Manager")
+	virtual int32 ReturnAllActive(const UClass* ObjectClass);
+
+	/** Returns active objects of all pools that match given predicate back to their pools in one batch.
+	 * @return Number of returned objects. */
+	virtual int32 ReturnAllActiveByPredicate(const TFunctionRef<bool(const UObject* PoolObject)> Predicate);
+
+	/** Returns all active objects of given class. */
+	UFUNCTION(BlueprintPure, Category = "Pool Manager")
+	void GetActiveObjects(const UClass* ObjectClass, TArray<UObject*>& OutObjects) const;
+
+	/** Returns number of active objects in pool by specified class. */
+	UFUNCTION(BlueprintPure, Category = "Pool Manager")
+	int32 GetActiveObjectsNum(const UClass* ObjectClass) const;
+
+	/*********************************************************************************************
+	 * Active Objects - Spatial Index
+	 * Use it to find active pooled actors by location, e.g: nearest pickup or farthest effect to recycle, without physics queries.
+	 ********************************************************************************************* */
+public:
+	/** Starts tracking locations of active actors of given class in the spatial hash of its pool.
+	 * Locations are updated automatically on take, return and movement of actors.
+	 * @param ObjectClass The class of actors, children classes have own pools and have to be enabled separately.
+	 * @param CellSize The size of one cell in centimeters, is best to be close to typical query radius. */
+	UFUNCTION(BlueprintCallable, Category = "Pool Manager")
+	virtual void EnableSpatialIndex(const UClass* ObjectClass, float CellSize = 500.f);
+
+	/** Stops tracking locations of active actors of given class. */
+	UFUNCTION(BlueprintCallable, Category = "Pool Manager")
+	virtual void DisableSpatialIndex(const UClass* ObjectClass);
+
+	/** Returns true if locations of active actors of given class are tracked. */
+	UFUNCTION(BlueprintPure, Category = "Pool Manager")
+	bool IsSpatialIndexEnabled(const UClass* ObjectClass) const;
+
+	/** Returns active actors of given class within specified radius. */
+	UFUNCTION(BlueprintCallable, Category = "Pool Manager")
+	void FindActiveActorsInRadius(const UClass* ObjectClass, const FVector& Center, float Radius, TArray<AActor*>& OutActors) const;
+
+	/** Returns up to specified number of active actors of given class that are nearest to the location, sorted from the nearest one. */
+	UFUNCTION(BlueprintCallable, Category = "Pool Manager")
+	void FindNearestActiveActors(const UClass* ObjectClass, const FVector& Location, int32 MaxNum, TArray<AActor*>& OutActors) const;
+
+	/** Returns active actor of given class that is farthest from the location, e.g: to recycle the least noticeable effect. */
+	UFUNCTION(BlueprintPure, Category = "Pool Manager")
+	AActor* FindFarthestActiveActor(const UClass* ObjectClass, const FVector& Location) const;
+
+protected:
+	/** Adds taken actor to the spatial hash of its pool or removes returned one, is called on each state change in the pool. */
+	virtual void UpdateSpatialIndex(EPoolObjectState NewState, AActor& Actor, FPoolContainer& InPool);
+
+	/** Is called when root component of any tracked actor is moved. */
+	void OnTrackedActorMoved(USceneComponent* UpdatedComponent, EUpdateTransformFlags UpdateTransformFlags, ETeleportType Teleport);
+
+	/** Is called on next frame to track actors that had no root component when were taken, e.g: blueprint roots of just spawned actors. */
+	void OnNextTickTrackPendingActors();
+
+	/*********************************************************************************************
+	 * Prediction
+	 * Use it to show pooled actors on client immediately while the server's authoritative ones are on their way.
+	 ********************************************************************************************* */
+public:
+	/** CLIENT: takes local stand-in from the pool that predicts the actor to be taken by the server.
+	 * Send returned id to the server by your own RPC and pass it to TakeFromPoolForPrediction() there.
+	 * Server's actor class has to contain UPoolPredictionComponent to be reconciled with the stand-in.
+	 * @param ObjectClass The class of the stand-in to get from the pool.
+	 * @param Transform The transform to set for the stand-in.
+	 * @param OnReconciled Is called when the authoritative actor becomes relevant, right before the stand-in is returned to the pool.
+	 * @param Priority The priority of the request, is Critical by default to show the stand-in in the same frame.
+	 * @param Payload Optional data to configure the stand-in in one activation step.
+	 * @return Prediction id that is derived from the stand-in's handle, is invalid if failed. */
+	virtual FGuid TakePredictedFromPool(const UClass* ObjectClass, const FTransform& Transform = FTransform::Identity, const FOnPredictionReconciled& OnReconciled = nullptr, ESpawnRequestPriority Priority = ESpawnRequestPriority::Critical, const FInstancedStruct& Payload = FInstancedStruct());
+
+	/** SERVER: takes the authoritative actor from the pool that will replace client's stand-in with given prediction id.
+	 * Is the same as TakeFromPool(), but replicates the prediction id by actor's UPoolPredictionComponent. */
+	virtual FPoolObjectHandle TakeFromPoolForPrediction(const FGuid& PredictionId, const UClass* ObjectClass, const FTransform& Transform = FTransform::Identity, const FOnSpawnCallback& Completed = nullptr, ESpawnRequestPriority Priority = ESpawnRequestPriority::High, const FInstancedStruct& Payload = FInstancedStruct());
+
+	/** CLIENT: links the stand-in with the authoritative actor and returns the stand-in to the pool.
+	 * Is called automatically by UPoolPredictionComponent when its owner becomes relevant.
+	 * @return true if given prediction was pending and is reconciled. */
+	virtual bool ReconcilePrediction(const FGuid& PredictionId, AActor* AuthoritativeActor);
+
+	/** CLIENT: returns the stand-in to the pool without reconciliation, e.g: when the server rejected the request.
+	 * @return true if given prediction was pending and is cancelled. */
+	UFUNCTION(BlueprintCallable, Category = "Pool Manager")
+	virtual bool CancelPrediction(const FGuid& PredictionId);
+
+	/** Returns true if given prediction is waiting for the server's authoritative actor. */
+	UFUNCTION(BlueprintPure, Category = "Pool Manager")
+	bool IsPredictionPending(const FGuid& PredictionId) const { return PendingPredictionsInternal.Contains(PredictionId); }
+
 	/*********************************************************************************************
 	 * Advanced
 	 * In most cases, you don't need to use this section.
@@ -180,6 +299,12 @@ public:
 	bool RegisterObjectInPool(const FPoolObjectData& InData);
 	virtual bool RegisterObjectInPool_Implementation(const FPoolObjectData& InData);
 
+	/** Is the same as RegisterObjectInPool() but for multiple objects.
+	 * Is useful to register many existing objects at once, e.g: actors baked into the level by APoolPrebakedActors.
+	 * @return Number of registered objects. */
+	UFUNCTION(BlueprintCallable, Category = "Pool Manager")
+	virtual int32 RegisterObjectsArrayInPool(const TArray<FPoolObjectData>& InData);
+
 	/** Always creates new object and adds it to the pool by its class.
 	 * Use carefully if only there is no free objects contained in pool.
 	 * @param InRequest The request to spawn new object.
@@ -215,6 +340,10 @@ public:
 	UFUNCTION(BlueprintPure, Category = "Pool Manager")
 	static const UClass* GetObjectClassByFactory(const TSubclassOf<UPoolFactory_UObject>& FactoryClass);
 
+	/** Spawns all queued requests of all factories right now regardless of the spawn budget. */
+	UFUNCTION(BlueprintCallable, Category = "Pool Manager")
+	virtual void FlushSpawnQueues();
+
 protected:
 	/** Creates all possible Pool Factories to be used by the Pool Manager when dealing with objects. */
 	virtual void InitializeAllFactories();
@@ -222,6 +351,235 @@ protected:
 	/** Destroys all Pool Factories that are used by the Pool Manager when dealing with objects. */
 	virtual void ClearAllFactories();
 
+	/*********************************************************************************************
+	 * Advanced - Travel
+	 * Is used only if 'Persist Pools Across Travel' is enabled in the settings.
+	 ********************************************************************************************* */
+public:
+	/** Adds all free pooled actors that can travel to the next world.
+	 * Call it from your AGameModeBase::GetSeamlessTravelActorList() override to keep actor pools through seamless travel.
+	 * @param InOutActorList The seamless travel list of the game mode. */
+	UFUNCTION(BlueprintCallable, Category = "Pool Manager")
+	virtual void GetSeamlessTravelActors(UPARAM(ref) TArray<AActor*>& InOutActorList) const;
+
+protected:
+	/** Keeps free objects in the game instance, so they are adopted by the next world's Pool Manager instead of being destroyed.
+	 * Is called on deinitialization of the Pool Manager. */
+	virtual void StashPoolsForTravel();
+
+	/** Registers free objects that were kept from the previous world.
+	 * Is called on initialization and again on world's begin play for actors that finished traveling. */
+	virtual void AdoptPoolsAfterTravel();
+
+	/*********************************************************************************************
+	 * Advanced - Streaming
+	 * Use it to make pool memory follow the loaded region, e.g: in open worlds.
+	 ********************************************************************************************* */
+public:
+	/** Creates free objects next frames in advance, so they are ready to be taken with no spawn.
+	 * @param ObjectClass The class of objects to pre-warm.
+	 * @param Amount The total amount of objects the pool should contain, already registered and queued objects are included.
+	 * @param Priority The priority of pre-warming requests.
+	 * @return Number of newly requested objects. */
+	UFUNCTION(BlueprintCallable, Category = "Pool Manager")
+	virtual int32 PrewarmPool(const UClass* ObjectClass, int32 Amount, ESpawnRequestPriority Priority = ESpawnRequestPriority::Normal);
+
+	/** Destroys free objects next frames until the pool contains specified amount of objects.
+	 * Active objects are never destroyed, so the pool could stay bigger than specified amount.
+	 * 'SpawnObjectsPerFrame' also limits how many objects are destroyed per frame. */
+	UFUNCTION(BlueprintCallable, Category = "Pool Manager")
+	virtual void ShrinkPool(const UClass* ObjectClass, int32 Amount);
+
+	/** Pre-warms or shrinks the pool to exactly specified amount of objects, already registered and queued objects are included.
+	 * Unlike PrewarmPool(), neither 'PrewarmMultiplier' nor 'MaxFreeObjectsPerPool' is applied, e.g: for debugging the pool size.
+	 * @return Number of newly requested objects. */
+	UFUNCTION(BlueprintCallable, Category = "Pool Manager")
+	virtual int32 ResizePool(const UClass* ObjectClass, int32 Amount);
+
+	/** Ties the pool to the streaming level or data layer, so it is pre-warmed while the source is loaded and shrunk once unloaded.
+	 * Use data layers for World Partition, since its cells are streamed by generated levels.
+	 * Adding the same class and source again updates the amount. */
+	UFUNCTION(BlueprintCallable, Category = "Pool Manager")
+	virtual void AddStreamingPool(const FPoolStreamingBinding& Binding);
+
+	/** Unties the pool from given streaming level or data layer, the pool is shrunk to the amount of remaining loaded bindings. */
+	UFUNCTION(BlueprintCallable, Category = "Pool Manager")
+	virtual void RemoveStreamingPool(const FPoolStreamingBinding& Binding);
+
+	/** Returns the amount of objects of given class that is required by all loaded streaming bindings. */
+	UFUNCTION(BlueprintPure, Category = "Pool Manager")
+	int32 GetStreamingPoolAmount(const UClass* ObjectClass) const;
+
+protected:
+	/** Pre-warms the pool of given class to the amount required by loaded streaming bindings.
+	 * @param bShrink If true, also destroys free objects above the amount, is set when any binding is unloaded. */
+	virtual void UpdateStreamingPool(const UClass* ObjectClass, bool bShrink);
+
+	/** Updates loaded state of all streaming bindings and their pools.
+	 * @param UnloadingLevel Optional level that is being removed from the world, so it is not considered as loaded anymore. */
+	virtual void RefreshStreamingPools(const ULevel* UnloadingLevel = nullptr);
+
+	/** Returns true if the level or data layer of given binding is loaded in this world. */
+	virtual bool IsStreamingSourceLoaded(const FPoolStreamingBinding& Binding, const ULevel* UnloadingLevel = nullptr) const;
+
+	/** Is called on next frame to destroy a chunk of free objects of shrinking pools. */
+	virtual void OnNextTickProcessShrink();
+
+	/** Is called when any level becomes visible in any world. */
+	virtual void OnLevelAddedToWorld(ULevel* Level, UWorld* World);
+
+	/** Is called when any level is removed from any world. */
+	virtual void OnLevelRemovedFromWorld(ULevel* Level, UWorld* World);
+
+	/** Is called when runtime state of any data layer is changed in this world. */
+	UFUNCTION()
+	void OnDataLayerRuntimeStateChanged(const UDataLayerInstance* DataLayer, EDataLayerRuntimeState State);
+
+	/*********************************************************************************************
+	 * Advanced - Budget
+	 ********************************************************************************************* */
+public:
+	/** Sets the mode that affects how many objects are spawned per frame.
+	 * Is switched automatically: to Loading on world initialization and back to Gameplay once the world begins play and loading screen is finished.
+	 * The world does not tick while its map is loading, so with no loading screen movie, the loading budget is applied only once on begin play,
+	 * requests made later, e.g: by BeginPlay of actors, are spawned with the gameplay budget.
+	 * Call it manually if your game shows own loading screen. */
+	UFUNCTION(BlueprintCallable, Category = "Pool Manager")
+	virtual void SetSpawnBudgetMode(EPoolSpawnBudgetMode NewMode);
+
+	/** Returns the mode that affects how many objects are spawned per frame. */
+	UFUNCTION(BlueprintPure, Category = "Pool Manager")
+	EPoolSpawnBudgetMode GetSpawnBudgetMode() const { return SpawnBudgetModeInternal; }
+
+	/** Returns a limit of how many objects to spawn per frame according to current budget mode. */
+	UFUNCTION(BlueprintPure, Category = "Pool Manager")
+	virtual int32 GetSpawnObjectsPerFrame() const;
+
+	/** Returns milliseconds that spawning can take per frame according to current budget mode, 0 if only objects count is limited.
+	 * Is not limited while loading since frame time is not important then. */
+	UFUNCTION(BlueprintPure, Category = "Pool Manager")
+	virtual float GetSpawnBudgetMs() const;
+
+	/** Returns measured spawn, take and return costs of objects of given class.
+	 * Is useful for decisions like pre-warming only classes that are expensive to spawn. */
+	UFUNCTION(BlueprintPure, Category = "Pool Manager")
+	FPoolSpawnCost GetSpawnCost(const UClass* ObjectClass) const;
+
+	/** Destroys free objects above 'PoolManager.MaxFreeObjectsPerPool' and 'PoolManager.MemoryBudgetMB' limits.
+	 * Is called automatically next frame after objects are returned and when any budget console variable is changed. */
+	UFUNCTION(BlueprintCallable, Category = "Pool Manager")
+	virtual void EnforcePoolBudgets();
+
+	/** Returns estimated memory in bytes used by objects of given pool.
+	 * @param ObjectClass The class of the pool.
+	 * @param bFreeOnly If true, only free objects are counted. */
+	UFUNCTION(BlueprintPure, Category = "Pool Manager")
+	int64 GetPoolMemorySize(const UClass* ObjectClass, bool bFreeOnly = false) const;
+
+protected:
+	/** Is called when any budget console variable is changed to adjust pools live. */
+	virtual void OnPoolBudgetsChanged();
+
+	/** Schedules EnforcePoolBudgets() to next frame if any budget is limited, so all returns of the same frame are handled at once. */
+	void RequestEnforcePoolBudgets();
+
+	/** Spawns queued requests of all factories right now up to the loading budget.
+	 * Is called on begin play since no frame is ticked with the loading budget if there is no loading screen movie. */
+	virtual void ProcessLoadingSpawnBudget();
+
+	/** Is called when the loading screen movie is finished to switch back to the gameplay budget. */
+	virtual void OnLoadingScreenFinished();
+
+	/*********************************************************************************************
+	 * Advanced - Stats
+	 * Use it to set pool sizes and priorities from data, see also 'PoolManager.StatsLogInterval'.
+	 ********************************************************************************************* */
+public:
+	/** Returns approximate percentile of given latency metric of the pool, e.g: 0.95 for p95.
+	 * @param ObjectClass The class of the pool.
+	 * @param Metric The metric to return, in frames or milliseconds according to its name.
+	 * @param Percentile The ratio of samples from 0 to 1 that are less or equal to the returned value. */
+	UFUNCTION(BlueprintPure, Category = "Pool Manager")
+	float GetPoolLatencyPercentile(const UClass* ObjectClass, EPoolLatencyMetric Metric, float Percentile = 0.95f) const;
+
+	/** Returns latency histograms of the pool, or null if the pool is not registered. */
+	const FPoolLatencyStats* GetPoolLatencyStats(const UClass* ObjectClass) const;
+
+	/** Removes collected hits, misses and latency samples of all pools. */
+	UFUNCTION(BlueprintCallable, Category = "Pool Manager")
+	virtual void ResetPoolStats();
+
+	/** Prints hits, misses and latency percentiles of all pools to given output device.
+	 * Is called periodically with the log if 'PoolManager.StatsLogInterval' is set. */
+	virtual void LogPoolStats(FOutputDevice& Ar) const;
+
+	/** Adds queue wait and spawn duration of given request to the stats of its pool.
+	 * Is called by factories right after the requested object is spawned. */
+	virtual void RecordSpawnLatency(const FSpawnRequest& Request, double SpawnSeconds);
+
+	/*********************************************************************************************
+	 * Advanced - Leaks
+	 * Finds objects that are taken but never returned, see also 'PoolManager.LeakReport'.
+	 ********************************************************************************************* */
+public:
+	/** Overrides seconds after which active objects of given class and its children are reported as leaked.
+	 * @param ObjectClass The class of objects.
+	 * @param ThresholdSeconds Seconds of being active, 0 to never report, negative to use 'PoolManager.LeakThresholdSeconds' again. */
+	UFUNCTION(BlueprintCallable, Category = "Pool Manager")
+	virtual void SetLeakThreshold(const UClass* ObjectClass, float ThresholdSeconds);
+
+	/** Returns seconds after which active objects of given class are reported as leaked, 0 if never. */
+	UFUNCTION(BlueprintPure, Category = "Pool Manager")
+	float GetLeakThreshold(const UClass* ObjectClass) const;
+
+	/** Returns all active objects that are not returned to the pool longer than their leak threshold. */
+	UFUNCTION(BlueprintPure, Category = "Pool Manager")
+	void GetLeakedObjects(TArray<FPoolObjectData>& OutObjects) const;
+
+	/** Logs a warning once for each newly leaked object.
+	 * Is called automatically every few seconds while the world is playing. */
+	UFUNCTION(BlueprintCallable, Category = "Pool Manager")
+	virtual void DetectLeaks();
+
+	/** Prints all leaked objects grouped by callsites that took them, callsites are known only in non-shipping builds. */
+	virtual void LogLeakReport(FOutputDevice& Ar) const;
+
+	/*********************************************************************************************
+	 * Advanced - Owners
+	 * Use it to return all objects of weapons, abilities, UI screens etc. at once, with no own arrays of handles.
+	 ********************************************************************************************* */
+public:
+	/** Binds taken object to given owner, so it is returned to the pool once the owner is destroyed or ReturnAllOwnedBy() is called.
+	 * Actors are returned right on their owner's destroy, other owners are checked after each garbage collection.
+	 * Is called automatically if the owner is passed to TakeFromPool().
+	 * @param Handle The handle of taken object, can be still in the spawning queue.
+	 * @param Owner The object that owns taken object, null to unbind the object from its current owner. */
+	UFUNCTION(BlueprintCallable, Category = "Pool Manager")
+	virtual void AssignOwner(const FPoolObjectHandle& Handle, UObject* Owner);
+
+	/** Returns all objects of given owner back to their pools in one batch.
+	 * @return Number of returned objects. */
+	UFUNCTION(BlueprintCallable, Category = "Pool Manager", meta = (DefaultToSelf = "Owner"))
+	virtual int32 ReturnAllOwnedBy(const UObject* Owner);
+
+	/** Returns handles of all taken objects of given owner. */
+	UFUNCTION(BlueprintPure, Category = "Pool Manager", meta = (DefaultToSelf = "Owner"))
+	void GetOwnedHandles(const UObject* Owner, TArray<FPoolObjectHandle>& OutHandles) const;
+
+protected:
+	/** Returns all objects of the owner by its key back to their pools, the owner could be already destroyed. */
+	virtual int32 ReturnOwnedHandles(const TObjectKey<UObject>& OwnerKey);
+
+	/** Unbinds the object from its owner, is called when the object is returned to the pool. */
+	void ReleaseOwner(const FPoolObjectHandle& Handle);
+
+	/** Is called when any actor that owns pooled objects is destroyed. */
+	UFUNCTION()
+	void OnOwnerDestroyed(AActor* DestroyedActor);
+
+	/** Is called after each garbage collection to return objects of destroyed non-actor owners. */
+	virtual void OnPostGarbageCollect();
+
 	/*********************************************************************************************
 	 * Empty Pool
 	 ********************************************************************************************* */
@@ -297,6 +655,16 @@ public:
 	UFUNCTION(BlueprintPure, Category = "Pool Manager", meta = (DefaultToSelf = "Object"))
 	const FPoolObjectHandle& FindPoolHandleByObject(const UObject* Object) const;
 
+	/** Returns all pools that are handled by the Pool Manager. */
+	UFUNCTION(BlueprintPure, Category = "Pool Manager")
+	const FORCEINLINE TArray<FPoolContainer>& GetAllPools() const { return PoolsInternal; }
+
+	/** Returns all factories by classes of objects they handle. */
+	const FORCEINLINE TMap<TObjectPtr<const UClass>, TObjectPtr<UPoolFactory_UObject>>& GetAllFactories() const { return AllFactoriesInternal; }
+
+	/** Returns per-second history of takes by classes of pools, is sampled once per second while the world is playing. */
+	const FORCEINLINE TMap<const UClass*, FPoolTakeHistory>& GetTakeHistory() const { return TakeHistoryInternal; }
+
 	/** Returns from all given handles only valid ones. */
 	UFUNCTION(BlueprintPure, Category = "Pool Manager")
 	void FindPoolObjectsByHandles(TArray<FPoolObjectData>& OutObjects, const TArray<FPoolObjectHandle>& InHandles) const;
@@ -314,6 +682,61 @@ protected:
 	UPROPERTY(BlueprintReadWrite, Transient, Category = "Pool Manager", meta = (BlueprintProtected, DisplayName = "All Factories"))
 	TMap<TObjectPtr<const UClass>, TObjectPtr<UPoolFactory_UObject>> AllFactoriesInternal;
 
+	/** Client's stand-ins that wait for the server's authoritative actors by their prediction ids. */
+	TMap<FGuid, FPoolPrediction> PendingPredictionsInternal;
+
+	/** Current mode that affects how many objects are spawned per frame. */
+	UPROPERTY(VisibleInstanceOnly, BlueprintReadOnly, Transient, Category = "Pool Manager", meta = (BlueprintProtected, DisplayName = "Spawn Budget Mode"))
+	EPoolSpawnBudgetMode SpawnBudgetModeInternal = EPoolSpawnBudgetMode::Gameplay;
+
+	/** Is true when EnforcePoolBudgets() is scheduled to next frame. */
+	bool bIsEnforcePoolBudgetsPendingInternal = false;
+
+	/** Per-second history of takes by classes of pools. */
+	TMap<const UClass*, FPoolTakeHistory> TakeHistoryInternal;
+
+	/** Samples the take history once per second. */
+	FTimerHandle TakeHistoryTimerInternal;
+
+	/** Platform time in seconds when pool stats were printed to the log last time. */
+	double LastStatsLogTimeInternal = 0.0;
+
+	/** Seconds after which active objects are reported as leaked by their classes, overrides 'PoolManager.LeakThresholdSeconds'. */
+	UPROPERTY(VisibleInstanceOnly, BlueprintReadWrite, Transient, Category = "Pool Manager", meta = (BlueprintProtected, DisplayName = "Leak Thresholds"))
+	TMap<TObjectPtr<const UClass>, float> LeakThresholdsInternal;
+
+	/** Platform time in seconds when leaks were detected last time. */
+	double LastLeakScanTimeInternal = 0.0;
+
+	/** Address of the code that called the outermost take function, is recorded only in non-shipping builds. */
+	uint64 TakeCallsiteInternal = 0;
+
+#if !UE_BUILD_SHIPPING
+	/** Script callstacks by callsites of takes from Blueprints, is printed by leak reports instead of symbols. */
+	TMap<uint64, FString> ScriptCallsitesInternal;
+
+	/** Returns the callsite of the Blueprint function that is calling the take node right now and remembers its script callstack.
+	 * Is 0 if the take is not called by Blueprint. */
+	uint64 RecordScriptCallsite();
+#endif // !UE_BUILD_SHIPPING
+
+	/** Handles of taken objects by their owners. */
+	TMap<TObjectKey<UObject>, TArray<FPoolObjectHandle>> OwnedHandlesInternal;
+
+	/** Owners by handles of taken objects, is used to unbind returned objects fast. */
+	TMap<FPoolObjectHandle, TObjectKey<UObject>> HandleOwnersInternal;
+
+	/** Taken actors with no root component yet, they are added to the spatial hash next frame. */
+	TArray<TWeakObjectPtr<AActor>> PendingSpatialActorsInternal;
+
+	/** Pools tied to streaming levels or data layers. */
+	UPROPERTY(VisibleInstanceOnly, BlueprintReadWrite, Transient, Category = "Pool Manager", meta = (BlueprintProtected, DisplayName = "Streaming Pools"))
+	TArray<FPoolStreamingBinding> StreamingPoolsInternal;
+
+	/** Amounts of objects that shrinking pools should keep by their classes. */
+	UPROPERTY(VisibleInstanceOnly, BlueprintReadWrite, Transient, Category = "Pool Manager", meta = (BlueprintProtected, DisplayName = "Shrinking Pools"))
+	TMap<TObjectPtr<const UClass>, int32> ShrinkingPoolsInternal;
+
 	/*********************************************************************************************
 	 * Protected methods
 	 ********************************************************************************************* */
@@ -324,6 +747,12 @@ protected:
 	/** Is called on deinitialization of the Pool Manager instance. */
 	virtual void Deinitialize() override;
 
+	/** Is called when world is ready to start gameplay before the game mode transitions to the correct state and call BeginPlay on all actors. */
+	virtual void OnWorldBeginPlay(UWorld& InWorld) override;
+
+	/** Is called once per second to add new sample to the take history of each pool, to print pool stats and to detect leaks if it's time. */
+	virtual void OnSampleTakeHistory();
+
 	/** Returns the pointer to found pool by specified class. */
 	virtual FPoolContainer& FindPoolOrAdd(const UClass* ObjectClass);
 	virtual FPoolContainer* FindPool(const UClass* ObjectClass);
@@ -336,4 +765,15 @@ protected:
 	 * @param InPool The pool that contains the object.
 	 * @warning Do not call it directly, use TakeFromPool() or ReturnToPool() instead. */
 	virtual void SetObjectStateInPool(EPoolObjectState NewState, UObject& InObject, UPARAM(ref) FPoolContainer& InPool);
+
+	/** Is the part of SetObjectStateInPool() that does not touch the list of active objects, so mass returning updates that list once per pool.
+	 * @param NewState The state the object is already marked with.
+	 * @param InOutData The data of the object in given pool.
+	 * @param InPool The pool that contains the object. */
+	virtual void ApplyObjectStateInPool(EPoolObjectState NewState, FPoolObjectData& InOutData, FPoolContainer& InPool);
+
+	/** Returns active objects of given pool that match given predicate in one batch.
+	 * The list of active objects is walked once and is cleared or rebuilt once at the end instead of being updated per object.
+	 * @return Number of returned objects. */
+	virtual int32 ReturnActiveInPool(FPoolContainer& InPool, const TFunctionRef<bool(const UObject* PoolObject)> Predicate);
 };
@@ -4,11 +4,21 @@
 
 #include "UObject/Object.h"
 //---
+#include "Engine/TimerHandle.h"
 #include "Misc/Guid.h"
+#include "UObject/ObjectKey.h"
+#include "StructUtils/InstancedStruct.h"
 #include "Templates/NonNullSubclassOf.h"
 //---
+#include <atomic>
+//---
 #include "PoolManagerTypes.generated.h"
 
+POOLMANAGER_API DECLARE_LOG_CATEGORY_EXTERN(LogPoolManager, Log, All);
+
+// It's almost farthest possible location where inactive actors are placed until taken from pool
+#define VECTOR_HALF_WORLD_MAX FVector(HALF_WORLD_MAX - HALF_WORLD_MAX * THRESH_VECTOR_NORMALIZED)
+
 /**
  * States of the object in Pool
  */
@@ -41,8 +51,37 @@ enum class ESpawnRequestPriority : uint8
 	Critical,
 };
 
+/**
+ * Modes of the spawn budget that affect how many objects are spawned per frame.
+ */
+UENUM(BlueprintType)
+enum class EPoolSpawnBudgetMode : uint8
+{
+	///< Uses 'Spawn Objects Per Frame' to keep gameplay frame rate smooth
+	Gameplay,
+	///< Uses 'Loading Spawn Objects Per Frame' to fill pools faster while the map is loading or loading screen is shown
+	Loading
+};
+
+/**
+ * Latency metrics that are collected by each pool.
+ */
+UENUM(BlueprintType)
+enum class EPoolLatencyMetric : uint8
+{
+	///< Frames the spawn request waited in the queue until its object was spawned
+	QueueWaitFrames,
+	///< Milliseconds the spawn request waited in the queue until its object was spawned
+	QueueWaitMs,
+	///< Milliseconds the factory spent to spawn the object
+	SpawnMs,
+	///< Milliseconds the object was active from taking to returning to the pool
+	LifetimeMs
+};
+
 struct FSpawnRequest;
 struct FPoolObjectData;
+class AActor;
 
 /**
  * A handle for managing pool object indirectly.
@@ -147,6 +186,21 @@ struct POOLMANAGER_API FPoolObjectData
 	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Transient)
 	FPoolObjectHandle Handle = FPoolObjectHandle::EmptyHandle;
 
+	/** Platform time in seconds when the object was taken from the pool, is 0 while the object is free. */
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Transient)
+	double TakenTime = 0.0;
+
+	/** Address of the code that took the object from the pool, is used to group leaks by callsites.
+	 * Is recorded only in non-shipping builds, 0 if unknown. */
+	uint64 TakeCallsite = 0;
+
+	/** Is true once the object is reported as leaked, so it is reported only once per take. */
+	bool bIsLeakReported = false;
+
+	/** Position of this object in FPoolContainer::ActiveIndices, is INDEX_NONE if it is not listed there.
+	 * Is maintained by FPoolContainer::SetObjectActive(), so the object is removed from the list with no search. */
+	int32 ActiveIndex = INDEX_NONE;
+
 	/*********************************************************************************************
 	 * Getters and operators
 	 ********************************************************************************************* */
@@ -183,6 +237,125 @@ struct POOLMANAGER_API FPoolObjectData
 	friend POOLMANAGER_API bool operator==(const FPoolObjectData& A, const UObject* B) { return A.PoolObject == B; }
 };
 
+/**
+ * Counts samples in log2 buckets, so any range from one frame to minutes is kept in a few counters.
+ * Bucket 0 contains zero samples, bucket N contains samples in range [2^(N-1), 2^N), the last bucket contains all bigger ones.
+ * Counters are lock-free, so samples can be added from any thread.
+ */
+struct POOLMANAGER_API FPoolHistogram
+{
+	/** Number of log2 buckets, the last one contains samples bigger than 2^30. */
+	static constexpr int32 BucketsNum = 32;
+
+	/** Default constructor. */
+	FPoolHistogram() = default;
+
+	/** Copies current counters, since atomics can't be copied by default. */
+	FPoolHistogram(const FPoolHistogram& Other) { *this = Other; }
+	FPoolHistogram& operator=(const FPoolHistogram& Other);
+
+	/** Adds the sample to its bucket. */
+	void AddSample(uint64 Value);
+
+	/** Returns number of samples in given bucket. */
+	FORCEINLINE int32 GetBucketNum(int32 BucketIndex) const { return Buckets[BucketIndex].load(std::memory_order_relaxed); }
+
+	/** Returns the biggest value that is counted by given bucket. */
+	static uint64 GetBucketMaxValue(int32 BucketIndex);
+
+	/** Returns number of all samples. */
+	int32 GetSamplesNum() const;
+
+	/** Returns the biggest value of the bucket that contains specified percentile of samples, e.g: 0.95 for p95.
+	 * Is approximate up to x2 since only buckets are kept, 0 if there are no samples. */
+	uint64 GetPercentile(float Percentile) const;
+
+	/** Removes all samples. */
+	void Reset();
+
+private:
+	/** Number of samples per log2 bucket. */
+	std::atomic<int32> Buckets[BucketsNum] = {};
+};
+
+/**
+ * Latency histograms of one pool, are used to set pool sizes and priorities from data.
+ * @see UPoolManagerSubsystem::GetPoolLatencyPercentile().
+ */
+struct POOLMANAGER_API FPoolLatencyStats
+{
+	/** Frames spawn requests waited in the queue. */
+	FPoolHistogram QueueWaitFrames;
+
+	/** Microseconds spawn requests waited in the queue. */
+	FPoolHistogram QueueWaitMicroseconds;
+
+	/** Microseconds factory spent to spawn objects. */
+	FPoolHistogram SpawnMicroseconds;
+
+	/** Microseconds objects were active from taking to returning to the pool. */
+	FPoolHistogram LifetimeMicroseconds;
+
+	/** Returns the histogram of given metric, milliseconds metrics are kept in microseconds. */
+	const FPoolHistogram& GetHistogram(EPoolLatencyMetric Metric) const;
+
+	/** Removes all samples of all histograms. */
+	void Reset();
+};
+
+/**
+ * Spatial hash of locations of active pooled actors, is optional per pool.
+ * Answers radius, nearest and farthest queries without physics or scanning all objects.
+ * Is updated incrementally by the Pool Manager on take, return and movement of actors.
+ * @see UPoolManagerSubsystem::EnableSpatialIndex().
+ */
+struct POOLMANAGER_API FPoolSpatialHash
+{
+	/** Size of one cubic cell in centimeters, the hash is disabled while it is 0. */
+	float CellSize = 0.f;
+
+	/** Returns true if the hash is enabled for the pool. */
+	FORCEINLINE bool IsEnabled() const { return CellSize > 0.f; }
+
+	/** Returns number of actors in the hash. */
+	FORCEINLINE int32 Num() const { return Entries.Num(); }
+
+	/** Adds given actor or moves it to new location. */
+	void Update(const AActor& Actor, const FVector& Location);
+
+	/** Removes given actor from the hash. */
+	void Remove(const AActor& Actor);
+
+	/** Removes all actors from the hash. */
+	void Reset();
+
+	/** Returns all actors within given radius. */
+	void FindInRadius(TArray<AActor*>& OutActors, const FVector& Center, float Radius) const;
+
+	/** Returns up to specified number of actors that are nearest to given location, sorted from the nearest one. */
+	void FindNearest(TArray<AActor*>& OutActors, const FVector& Location, int32 MaxNum) const;
+
+	/** Returns the actor that is farthest from given location, or null if the hash is empty. */
+	AActor* FindFarthest(const FVector& Location) const;
+
+	/** Returns the cell that contains given location. */
+	FIntVector GetCell(const FVector& Location) const;
+
+private:
+	/** Location of the actor and its cell. */
+	struct FEntry
+	{
+		FVector Location = FVector::ZeroVector;
+		FIntVector Cell = FIntVector::ZeroValue;
+	};
+
+	/** Locations of all actors in the hash. */
+	TMap<TObjectKey<AActor>, FEntry> Entries;
+
+	/** Actors by occupied cells, empty cells are removed. */
+	TMap<FIntVector, TArray<TObjectKey<AActor>>> Cells;
+};
+
 /**
  * Keeps the objects by class to be handled by the Pool Manager.
  */
@@ -212,6 +385,31 @@ struct POOLMANAGER_API FPoolContainer
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Transient)
 	TArray<FPoolObjectData> PoolObjects;
 
+	/** Estimated memory in bytes used by one object of this pool, is measured once the first object is registered. */
+	UPROPERTY(VisibleInstanceOnly, BlueprintReadOnly, Transient)
+	int64 ObjectSizeBytes = 0;
+
+	/** Number of takes that were served by free objects of this pool. */
+	UPROPERTY(VisibleInstanceOnly, BlueprintReadOnly, Transient)
+	int32 HitsNum = 0;
+
+	/** Number of takes when this pool had no free objects, so new ones were spawned. */
+	UPROPERTY(VisibleInstanceOnly, BlueprintReadOnly, Transient)
+	int32 MissesNum = 0;
+
+	/** Latency histograms of this pool, are not exposed to reflection since their counters are lock-free. */
+	FPoolLatencyStats LatencyStats;
+
+	/** Indices of active objects in PoolObjects, is kept dense to iterate active objects without touching free ones.
+	 * Is not exposed to reflection, use SetObjectActive() to change the state of objects. */
+	TArray<int32> ActiveIndices;
+
+	/** Optional spatial hash of active actors of this pool, is disabled by default. */
+	FPoolSpatialHash SpatialHash;
+
+	/** Returns the ratio of takes that were served by free objects, from 0 to 1. */
+	FORCEINLINE float GetHitRate() const { return HitsNum + MissesNum > 0 ? static_cast<float>(HitsNum) / (HitsNum + MissesNum) : 0.f; }
+
 	/** Returns the pointer to the Pool element by specified object. */
 	FPoolObjectData* FindInPool(const UObject& Object);
 	const FORCEINLINE FPoolObjectData* FindInPool(const UObject& Object) const { return const_cast<FPoolContainer*>(this)->FindInPool(Object); }
@@ -223,6 +421,15 @@ struct POOLMANAGER_API FPoolContainer
 	/** Returns factory or crashes as critical error if it is not set. */
 	UPoolFactory_UObject& GetFactoryChecked() const;
 
+	/** Marks given object of this pool as active or free and updates the list of active objects. */
+	void SetObjectActive(FPoolObjectData& InOutData, bool bNewActive);
+
+	/** Rebuilds the list of active objects, is called after objects are removed from the pool since their indices are shifted. */
+	void RebuildActiveIndices();
+
+	/** Returns number of active objects in this pool. */
+	FORCEINLINE int32 GetActiveObjectsNum() const { return ActiveIndices.Num(); }
+
 	/** Returns true if the class is set for the Pool. */
 	FORCEINLINE bool IsValid() const { return ObjectClass != nullptr; }
 
@@ -231,8 +438,49 @@ struct POOLMANAGER_API FPoolContainer
 	friend POOLMANAGER_API bool operator==(const FPoolContainer& A, const UClass* B) { return A.ObjectClass == B; }
 };
 
+/**
+ * Moving estimates of how much time objects of one class cost to the game thread.
+ * Is measured by the factory and is used to pack spawns of each frame into 'Spawn Budget Ms'.
+ * @see UPoolFactory_UObject::GetSpawnCost().
+ */
+USTRUCT(BlueprintType)
+struct POOLMANAGER_API FPoolSpawnCost
+{
+	GENERATED_BODY()
+
+	/** Weight of each new sample in the moving estimate, is small enough to ignore rare hitches. */
+	static constexpr float SmoothingFactor = 0.2f;
+
+	/** Milliseconds to spawn and register one object. */
+	UPROPERTY(VisibleInstanceOnly, BlueprintReadOnly, Transient)
+	float SpawnMs = 0.f;
+
+	/** Milliseconds to take one free object from the pool. */
+	UPROPERTY(VisibleInstanceOnly, BlueprintReadOnly, Transient)
+	float TakeMs = 0.f;
+
+	/** Milliseconds to return one object back to the pool. */
+	UPROPERTY(VisibleInstanceOnly, BlueprintReadOnly, Transient)
+	float ReturnMs = 0.f;
+
+	/** Number of measured spawns, the estimate is not known while it is 0. */
+	UPROPERTY(VisibleInstanceOnly, BlueprintReadOnly, Transient)
+	int32 SpawnSamplesNum = 0;
+
+	/** Number of measured takes and returns. */
+	int32 TakeSamplesNum = 0;
+	int32 ReturnSamplesNum = 0;
+
+	/** Is true once the warning about exceeded spawn budget is logged, so it's logged only once per class. */
+	bool bIsOverBudgetWarned = false;
+
+	/** Adds measured time to given moving estimate. */
+	static void AddSample(float& InOutEstimateMs, int32& InOutSamplesNum, double Seconds);
+};
+
 typedef TFunction<void(const FPoolObjectData&)> FOnSpawnCallback;
 typedef TFunction<void(const TArray<FPoolObjectData>&)> FOnSpawnAllCallback;
+typedef TFunction<void(UObject* StandIn, class AActor* AuthoritativeActor)> FOnPredictionReconciled;
 
 /**
  * Contains the functions that are called when the object is spawned.
@@ -246,6 +494,52 @@ struct POOLMANAGER_API FSpawnCallbacks
 	FOnSpawnCallback OnPostSpawned = nullptr;
 };
 
+/**
+ * Keeps per-second history of takes of one pool, is sampled by the Pool Manager to see the pool pressure while playing.
+ */
+struct POOLMANAGER_API FPoolTakeHistory
+{
+	/** Number of last seconds that are kept in the history. */
+	static constexpr int32 SecondsNum = 30;
+
+	/** Number of takes per second in the ring buffer. */
+	int32 TakesPerSecond[SecondsNum] = {};
+
+	/** Number of takes per second that were not served by free objects in the ring buffer. */
+	int32 MissesPerSecond[SecondsNum] = {};
+
+	/** Index of the ring buffer where the next second is written. */
+	int32 NextIndex = 0;
+
+	/** Total hits and misses of the pool at the moment of the last sample. */
+	int32 LastHitsNum = 0;
+	int32 LastMissesNum = 0;
+
+	/** Adds new second to the history by current total hits and misses of the pool. */
+	void AddSample(int32 HitsNum, int32 MissesNum);
+
+	/** Returns number of takes of given second, where 0 is the oldest one. */
+	FORCEINLINE int32 GetTakesNum(int32 SecondIndex) const { return TakesPerSecond[(NextIndex + SecondIndex) % SecondsNum]; }
+
+	/** Returns number of misses during specified last seconds. */
+	int32 GetMissesNum(int32 LastSecondsNum) const;
+};
+
+/**
+ * Keeps the client's stand-in that predicts the server's authoritative pooled actor.
+ */
+struct POOLMANAGER_API FPoolPrediction
+{
+	/** Handle of the local stand-in that was taken from the pool on client. */
+	FPoolObjectHandle StandInHandle = FPoolObjectHandle::EmptyHandle;
+
+	/** Is called when the authoritative actor becomes relevant, right before the stand-in is returned to the pool. */
+	FOnPredictionReconciled OnReconciled = nullptr;
+
+	/** Returns the stand-in to the pool if the server never confirms the prediction. */
+	FTimerHandle TimeoutHandle;
+};
+
 /**
  * Define a structure to hold the necessary information for spawning an object.
  */
@@ -270,10 +564,20 @@ struct POOLMANAGER_API FSpawnRequest
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Transient)
 	FTransform Transform = FTransform::Identity;
 
+	/** Optional data to configure the object in one activation step before it becomes visible or relevant.
+	 * Is passed to the factory and to IPoolObjectCallback, e.g: owner, instigator, velocity, damage, team etc. */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Transient)
+	FInstancedStruct Payload;
+
 	/** Priority of the spawn request in the queue, higher priority object is spawned first. */
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Transient)
 	ESpawnRequestPriority Priority = ESpawnRequestPriority::Normal;
 
+	/** Is true if the object is spawned in advance to warm up the pool, so it is registered as free instead of being taken.
+	 * @see UPoolManagerSubsystem::PrewarmPool(). */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Transient)
+	bool bIsPrewarm = false;
+
 	/** The handle associated with spawning pool object for management within the Pool Manager system.
 	 * Is generated automatically if not set. */
 	UPROPERTY(BlueprintReadOnly, Transient)
@@ -282,6 +586,15 @@ struct POOLMANAGER_API FSpawnRequest
 	/** Contains the functions that are called when the object is spawned. */
 	FSpawnCallbacks Callbacks;
 
+	/** Frame number when this request was queued, is used to measure how long it waits. */
+	uint64 RequestedFrame = 0;
+
+	/** Platform time in seconds when this request was queued, is used to measure how long it waits. */
+	double RequestedTime = 0.0;
+
+	/** Address of the code that requested the object, is passed to spawned object to group leaks by callsites. */
+	uint64 TakeCallsite = 0;
+
 	/** Returns true if this spawn request can be processed. */
 	FORCEINLINE bool IsValid() const { return Handle.IsValid(); }
 
@@ -292,3 +605,46 @@ struct POOLMANAGER_API FSpawnRequest
 	template <typename T = UObject>
 	FORCEINLINE TNonNullSubclassOf<T> GetClassChecked() const { return TNonNullSubclassOf<T>(const_cast<UClass*>(Handle.GetObjectClass())); }
 };
+
+/**
+ * Ties the pool of specified class to the streaming level or data layer.
+ * While any of its sources is loaded, the pool is pre-warmed to the specified amount,
+ * once all of them are unloaded, free objects are destroyed asynchronously, so pool memory follows the loaded region.
+ * @see UPoolManagerSubsystem::AddStreamingPool().
+ */
+USTRUCT(BlueprintType)
+struct POOLMANAGER_API FPoolStreamingBinding
+{
+	GENERATED_BODY()
+
+	/** Class of objects to keep in the pool while the source is loaded. */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+	TSubclassOf<UObject> ObjectClass = nullptr;
+
+	/** Amount of objects to keep in the pool while the source is loaded.
+	 * Amounts of all loaded bindings of the same class are summed up. */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, meta = (ClampMin = "0"))
+	int32 Amount = 0;
+
+	/** Optional streaming level (or sublevel) whose loading pre-warms the pool. */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+	TSoftObjectPtr<class UWorld> Level = nullptr;
+
+	/** Optional World Partition data layer whose activation pre-warms the pool. */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+	TObjectPtr<const class UDataLayerAsset> DataLayer = nullptr;
+
+	/** Priority of pre-warming requests, is Normal by default to not compete with gameplay requests. */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+	ESpawnRequestPriority Priority = ESpawnRequestPriority::Normal;
+
+	/** Is true while the level or data layer is loaded, is set by the Pool Manager. */
+	UPROPERTY(VisibleInstanceOnly, BlueprintReadOnly, Transient)
+	bool bIsLoaded = false;
+
+	/** Returns true if this binding has the class and any source to follow. */
+	FORCEINLINE bool IsValid() const { return ObjectClass && (!Level.IsNull() || DataLayer); }
+
+	/** Compares bindings by their class and sources, the amount is not compared. */
+	FORCEINLINE bool operator==(const FPoolStreamingBinding& Other) const { return ObjectClass == Other.ObjectClass && Level == Other.Level && DataLayer == Other.DataLayer; }
+};
@@ -3,6 +3,7 @@
 #pragma once
 
 #include "UObject/Interface.h"
+#include "StructUtils/InstancedStruct.h"
 #include "PoolObjectCallback.generated.h"
 
 enum class EPoolObjectState : uint8;
@@ -26,9 +27,21 @@ public:
 	 * Called when the object is taken from the pool.If IsNewSpawned is true, the object is newly spawned.
 	 * @param bIsNewSpawned If true, the object is newly spawned.
 	 * @param Transform The transform of the object.
+	 * @param Payload Optional data passed to TakeFromPool() to fully configure the object in one activation step.
 	 */
-	UFUNCTION(BlueprintNativeEvent, Category = "PoolManager", meta = (AutoCreateRefTerm = "Transform"))
-	void OnTakeFromPool(bool bIsNewSpawned, const FTransform& Transform);
+	UFUNCTION(BlueprintNativeEvent, Category = "PoolManager", meta = (AutoCreateRefTerm = "Transform,Payload"))
+	void OnTakeFromPool(bool bIsNewSpawned, const FTransform& Transform, const FInstancedStruct& Payload);
+	virtual void OnTakeFromPool_Implementation(bool bIsNewSpawned, const FTransform& Transform, const FInstancedStruct& Payload)
+	{
+		// Keeps code implementations of the old signature working until they are updated
+		PRAGMA_DISABLE_DEPRECATION_WARNINGS
+		OnTakeFromPool_Implementation(bIsNewSpawned, Transform);
+		PRAGMA_ENABLE_DEPRECATION_WARNINGS
+	}
+
+	/** Is the old signature with no payload, is called by the default implementation of the new one.
+	 * Implementations that override only the new signature should add 'using IPoolObjectCallback::OnTakeFromPool_Implementation;' to keep this one visible. */
+	UE_DEPRECATED(5.5, "Override OnTakeFromPool_Implementation with the Payload parameter instead.")
 	virtual void OnTakeFromPool_Implementation(bool bIsNewSpawned, const FTransform& Transform) {}
 
 	/**
@@ -7,6 +7,7 @@
 #include "EdGraphSchema_K2.h"
 #include "K2Node_CallFunction.h"
 #include "KismetCompiler.h"
+#include "StructUtils/InstancedStruct.h"
 //---
 #include UE_INLINE_GENERATED_CPP_BY_NAME(K2Node_TakeFromPool)
 
@@ -40,6 +41,21 @@ bool UK2Node_TakeFromPool::PostExpandNode(FKismetCompilerContext& CompilerContex
 		bIsErrorFree = false;
 	}
 
+	// connect to payload input
+	UEdGraphPin* CallPayloadPin = CallTakeFromPoolNode.FindPin(PayloadInputName);
+	UEdGraphPin* PayloadPin = FindPin(PayloadInputName);
+	if (PayloadPin && CallPayloadPin)
+	{
+		if (PayloadPin->LinkedTo.Num() > 0)
+		{
+			bIsErrorFree &= CompilerContext.MovePinLinksToIntermediate(*PayloadPin, *CallPayloadPin).CanSafeConnect();
+		}
+	}
+	else
+	{
+		bIsErrorFree = false;
+	}
+
 	return bIsErrorFree;
 }
 
@@ -49,4 +65,6 @@ void UK2Node_TakeFromPool::AllocateDefaultPins()
 	Super::AllocateDefaultPins();
 
 	CreatePin(EGPD_Input, UEdGraphSchema_K2::PC_Struct, TBaseStructure<FTransform>::Get(), TransformInputName);
+
+	CreatePin(EGPD_Input, UEdGraphSchema_K2::PC_Struct, FInstancedStruct::StaticStruct(), PayloadInputName);
 }
@@ -16,6 +16,7 @@ class POOLMANAGEREDITOR_API UK2Node_TakeFromPool : public UK2Node_TakeFromPoolBa
 
 public:
 	static inline const FName TransformInputName = TEXT("Transform");
+	static inline const FName PayloadInputName = TEXT("Payload");
 
 	// UK2Node_TakeFromPoolBase
 	virtual FORCEINLINE FName GetReturnValuePinName() override { return TEXT("Object"); }